@@ -0,0 +1,225 @@
+// Snapshot codec benchmark: msgpack batch_update vs bit-packed snapshot_codec.
+// Build and run with: make bench SANITIZER_FLAGS= && ./build/codec_bench [objects] [iterations]
+
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <random>
+
+#include "constants.h"
+#include "game_object.h"
+#include "interest_set.h"
+#include "snapshot_codec.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Objects within spread * the view half-extents of (cx, cy).
+std::vector<std::shared_ptr<GameObject>> MakeObjects(int count, double cx, double cy, long long now, std::mt19937& rng,
+                                                     double spread = 0.5) {
+    std::uniform_real_distribution<double> dx(-constants::FIXED_VIEW_WIDTH * spread, constants::FIXED_VIEW_WIDTH * spread);
+    std::uniform_real_distribution<double> dy(-constants::FIXED_VIEW_HEIGHT * spread, constants::FIXED_VIEW_HEIGHT * spread);
+    std::uniform_real_distribution<double> speed(-300.0, 300.0);
+
+    std::vector<std::shared_ptr<GameObject>> objects;
+    for (int i = 0; i < count; i++) {
+        std::shared_ptr<GameObject> obj;
+        if (i % 3 == 0) {
+            obj = std::make_shared<Player>();
+            obj->set_type("player");
+            obj->set_id("player_" + std::to_string(i) + "_1731400000000");
+            obj->set_username("Player_" + std::to_string(i));
+            obj->set_size(20);
+            obj->set_life_length(static_cast<long long>(4e18));
+        } else {
+            auto snowball = std::make_shared<Snowball>("snowball_player_" + std::to_string(i) + "_1731400000000_" + std::to_string(i), "snowball");
+            snowball->set_vx(speed(rng));
+            snowball->set_vy(speed(rng));
+            snowball->set_size(5);
+            snowball->set_damage(10);
+            snowball->set_life_length(5000);
+            obj = snowball;
+        }
+        obj->set_x(cx + dx(rng));
+        obj->set_y(cy + dy(rng));
+        obj->set_time_update(now - 20);
+        objects.push_back(obj);
+    }
+    return objects;
+}
+
+void Jitter(std::vector<std::shared_ptr<GameObject>>& objects, std::mt19937& rng) {
+    std::uniform_real_distribution<double> step(-3.0, 3.0);
+    for (auto& obj : objects) {
+        obj->set_x(obj->get_x() + step(rng));
+        obj->set_y(obj->get_y() + step(rng));
+    }
+}
+
+struct Result {
+    size_t spawn_bytes = 0, steady_bytes = 0;
+    double encode_ns = 0, decode_ns = 0;
+};
+
+Result BenchMsgPack(std::vector<std::shared_ptr<GameObject>>& objects, long long now, int iterations, std::mt19937 rng,
+                    const InterestSet::UpdateBudget* budget = nullptr) {
+    Result result;
+    InterestSet interest;
+    msgpack::sbuffer buffer;
+
+    auto pack = [&](long long t) {
+        buffer.clear();
+        msgpack::packer<msgpack::sbuffer> pk(&buffer);
+        pk.pack_map(BatchUpdate::kFieldCount);
+        schema::PackKey(pk, BatchUpdate::Key(BatchUpdate::Field::message_type)); pk.pack("batch_update");
+        schema::PackKey(pk, BatchUpdate::Key(BatchUpdate::Field::timestamp)); pk.pack(t);
+        interest.PackDelta(pk, objects, t, budget);
+        schema::PackKey(pk, BatchUpdate::Key(BatchUpdate::Field::events)); pk.pack_array(0);
+    };
+
+    pack(now);
+    result.spawn_bytes = buffer.size();
+
+    // With a budget frame sizes vary tick to tick; report the mean
+    // Time only the packing: moving the objects is the game's work, not the codec's
+    size_t total_bytes = 0;
+    Clock::duration encode_time{};
+    for (int i = 0; i < iterations; i++) {
+        Jitter(objects, rng);
+        auto start = Clock::now();
+        pack(now);
+        encode_time += Clock::now() - start;
+        total_bytes += buffer.size();
+    }
+    result.encode_ns = std::chrono::duration<double, std::nano>(encode_time).count() / iterations;
+    result.steady_bytes = total_bytes / iterations;
+
+    auto start = Clock::now();
+    size_t decoded = 0;
+    for (int i = 0; i < iterations; i++) {
+        msgpack::object_handle handle = msgpack::unpack(buffer.data(), buffer.size());
+        decoded += handle.get().via.map.size;
+    }
+    result.decode_ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / iterations;
+    if (decoded == 0) std::cerr << "msgpack decode produced nothing\n";
+    return result;
+}
+
+Result BenchPacked(std::vector<std::shared_ptr<GameObject>>& objects, double vx, double vy, long long now,
+                   int iterations, std::mt19937 rng, double& max_position_error) {
+    Result result;
+    InterestSet interest;
+    BitWriter writer;
+    std::vector<GameEvent> events;
+    snapshot_codec::DecodedSnapshot snapshot;
+
+    interest.Update(objects);
+    snapshot_codec::Encode(writer, interest, events, vx, vy, now);
+    result.spawn_bytes = writer.size();
+
+    auto start = Clock::now();
+    for (int i = 0; i < iterations; i++) {
+        Jitter(objects, rng);
+        interest.Update(objects);
+        snapshot_codec::Encode(writer, interest, events, vx, vy, now);
+    }
+    result.encode_ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / iterations;
+    result.steady_bytes = writer.size();
+
+    start = Clock::now();
+    for (int i = 0; i < iterations; i++) {
+        if (!snapshot_codec::Decode(writer.data(), writer.size(), snapshot)) {
+            std::cerr << "packed decode failed\n";
+            break;
+        }
+    }
+    result.decode_ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / iterations;
+
+    // Round-trip check: every decoded position must be within half a quantum
+    long long last = now;
+    max_position_error = 0;
+    for (size_t i = 0; i < snapshot.updates.size() && i < interest.updates().size(); i++) {
+        const auto& obj = *interest.updates()[i]->obj;
+        max_position_error = std::max({max_position_error,
+                                       std::abs(snapshot.updates[i].x - obj.get_cur_x(last)),
+                                       std::abs(snapshot.updates[i].y - obj.get_cur_y(last))});
+    }
+    return result;
+}
+
+void PrintRow(const char* name, const Result& r, int objects) {
+    std::cout << std::left << std::setw(12) << name
+              << std::right << std::setw(12) << r.spawn_bytes
+              << std::setw(12) << std::fixed << std::setprecision(1) << double(r.spawn_bytes) / objects
+              << std::setw(12) << r.steady_bytes
+              << std::setw(12) << double(r.steady_bytes) / objects
+              << std::setw(14) << r.encode_ns / 1000.0
+              << std::setw(14) << r.decode_ns / 1000.0 << "\n";
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    int object_count = argc > 1 ? std::stoi(argv[1]) : 60;
+    int iterations = argc > 2 ? std::stoi(argv[2]) : 20000;
+    const double viewer_x = 800, viewer_y = 800;
+    const long long now = 1731400000000LL;
+
+    std::mt19937 rng(42);
+    auto objects = MakeObjects(object_count, viewer_x, viewer_y, now, rng);
+    auto objects_copy = MakeObjects(object_count, viewer_x, viewer_y, now, rng);
+
+    Result msgpack_result = BenchMsgPack(objects, now, iterations, rng);
+    double max_error = 0;
+    Result packed_result = BenchPacked(objects_copy, viewer_x, viewer_y, now, iterations, rng, max_error);
+
+    std::cout << "Snapshot codec benchmark: " << object_count << " visible objects, "
+              << iterations << " iterations\n";
+    std::cout << std::left << std::setw(12) << "Format"
+              << std::right << std::setw(12) << "Spawn(B)"
+              << std::setw(12) << "B/obj"
+              << std::setw(12) << "Steady(B)"
+              << std::setw(12) << "B/obj"
+              << std::setw(14) << "Encode(us)"
+              << std::setw(14) << "Decode(us)" << "\n";
+    std::cout << std::string(88, '-') << "\n";
+    PrintRow("msgpack", msgpack_result, object_count);
+    PrintRow("packed", packed_result, object_count);
+    std::cout << "\nSteady-state size ratio: " << std::setprecision(2)
+              << double(packed_result.steady_bytes) / msgpack_result.steady_bytes << "x\n";
+    std::cout << "Max round-trip position error: " << std::setprecision(4) << max_error << " px (quantum "
+              << 1.0 / snapshot_codec::kPositionScale << " px)\n";
+
+    // Priority accumulator: the same codec over a full view (3200x1800) of
+    // objects, every object every tick vs distance-based rates
+    const int view_objects = object_count * 4;
+    InterestSet::UpdateBudget budget;
+    budget.viewer_x = viewer_x;
+    budget.viewer_y = viewer_y;
+    budget.current_time = now;
+    budget.max_bytes = 8192;
+    budget.spawn_bytes = InterestSet::kMsgPackSpawnBytes;
+    budget.update_bytes = InterestSet::kMsgPackUpdateBytes;
+    InterestSet::UpdateBudget uncapped = budget;
+    uncapped.max_bytes = 0;
+    auto full_view = MakeObjects(view_objects, viewer_x, viewer_y, now, rng, 1.0);
+    auto full_view_copy = MakeObjects(view_objects, viewer_x, viewer_y, now, rng, 1.0);
+    auto uncapped_view = MakeObjects(view_objects, viewer_x, viewer_y, now, rng, 1.0);
+    Result all_result = BenchMsgPack(full_view, now, iterations / 4, rng);
+    Result priority_result = BenchMsgPack(full_view_copy, now, iterations / 4, rng, &budget);
+    Result uncapped_result = BenchMsgPack(uncapped_view, now, iterations / 4, rng, &uncapped);
+
+    std::cout << "\nPriority accumulator: " << view_objects << " objects across the full view, msgpack, "
+              << budget.max_bytes << " B budget\n";
+    std::cout << std::string(88, '-') << "\n";
+    PrintRow("every tick", all_result, view_objects);
+    PrintRow("priority", priority_result, view_objects);
+    PrintRow("no cap", uncapped_result, view_objects);
+    std::cout << "\nSteady-state size ratio: " << std::setprecision(2)
+              << double(priority_result.steady_bytes) / all_result.steady_bytes << "x, encode time ratio: "
+              << priority_result.encode_ns / all_result.encode_ns << "x\n";
+
+    return max_error <= 0.5 / snapshot_codec::kPositionScale + 1e-9 ? 0 : 1;
+}
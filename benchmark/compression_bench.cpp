@@ -0,0 +1,232 @@
+// permessage-deflate cost/benefit benchmark for batch_update frames.
+// Build and run with: make bench SANITIZER_FLAGS= && ./build/compression_bench [clients,...] [ticks]
+//
+// Simulates every client's view of one shared world, packs the same msgpack
+// frames the server sends, then deflates them the way uWS does for each
+// compression mode: shared (fresh context per message) and dedicated
+// (per-connection sliding window, Z_SYNC_FLUSH), across size thresholds.
+
+#include <time.h>
+#include <zlib.h>
+
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+
+#include "constants.h"
+#include "game_object.h"
+#include "grid.h"
+#include "interest_set.h"
+
+namespace {
+
+double ThreadCpuMs() {
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+struct Policy {
+    std::string name;
+    bool dedicated;
+    int window_bits, mem_level;  // Matches uWS CompressOptions encoding
+    size_t threshold;
+};
+
+// Deflates messages like uWS's DeflationStream (raw deflate, trailing 4 bytes stripped).
+class Deflater {
+public:
+    Deflater(int window_bits, int mem_level) {
+        deflateInit2(&stream_, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -window_bits, mem_level, Z_DEFAULT_STRATEGY);
+    }
+    ~Deflater() { deflateEnd(&stream_); }
+    Deflater(const Deflater&) = delete;
+    Deflater& operator=(const Deflater&) = delete;
+
+    size_t Compress(const std::string& in, bool reset) {
+        out_.resize(deflateBound(&stream_, in.size()) + 16);
+        stream_.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(in.data()));
+        stream_.avail_in = static_cast<uInt>(in.size());
+        stream_.next_out = reinterpret_cast<Bytef*>(out_.data());
+        stream_.avail_out = static_cast<uInt>(out_.size());
+        deflate(&stream_, Z_SYNC_FLUSH);
+        size_t produced = out_.size() - stream_.avail_out;
+        if (reset) deflateReset(&stream_);
+        return produced > 4 ? produced - 4 : produced;
+    }
+
+private:
+    z_stream stream_{};
+    std::string out_;
+};
+
+struct Client {
+    std::shared_ptr<Player> player;
+    InterestSet interest;
+};
+
+// Runs the simulation and hands every client's frame to on_frame(tick, client, frame)
+// as it is produced, so frames never have to be kept around.
+template <typename OnFrame>
+double SimulateFrames(int clients, int ticks, OnFrame on_frame) {
+    Grid grid(1600, 1600, 100);
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<double> pos(0, 1599), speed(-300, 300);
+    const long long start = 1731400000000LL;
+
+    std::vector<Client> world(clients);
+    std::vector<std::shared_ptr<Snowball>> snowballs;
+    for (int i = 0; i < clients; i++) {
+        auto player = std::make_shared<Player>();
+        player->set_type("player");
+        player->set_id("player_" + std::to_string(i) + "_1731400000000");
+        player->set_username("Player_" + std::to_string(i));
+        player->set_size(20);
+        player->set_x(pos(rng));
+        player->set_y(pos(rng));
+        player->set_life_length(static_cast<long long>(4e18));
+        grid.Insert(player);
+        world[i].player = player;
+
+        auto snowball = std::make_shared<Snowball>("snowball_" + player->get_id() + "_0", "snowball");
+        snowball->set_x(pos(rng));
+        snowball->set_y(pos(rng));
+        snowball->set_vx(speed(rng));
+        snowball->set_vy(speed(rng));
+        snowball->set_size(5);
+        snowball->set_damage(10);
+        snowball->set_time_update(start);
+        snowball->set_life_length(5000);
+        grid.Insert(snowball);
+        snowballs.push_back(snowball);
+    }
+
+    std::uniform_real_distribution<double> step(-3, 3);
+    msgpack::sbuffer buffer;
+    std::string frame;
+    double pack_ms = 0;
+
+    for (int tick = 0; tick < ticks; tick++) {
+        long long now = start + tick * 10;
+        for (auto& client : world) {
+            client.player->set_x(std::clamp(client.player->get_x() + step(rng), 0.0, 1599.0));
+            client.player->set_y(std::clamp(client.player->get_y() + step(rng), 0.0, 1599.0));
+            grid.Update(client.player, 0);
+        }
+        for (auto& snowball : snowballs) grid.Update(snowball, now);
+
+        for (int i = 0; i < clients; i++) {
+            double cpu_start = ThreadCpuMs();
+            auto& player = world[i].player;
+            double lower_y = player->get_y() - constants::FIXED_VIEW_HEIGHT;
+            double left_x = player->get_x() - constants::FIXED_VIEW_WIDTH;
+            auto neighbors = grid.Search(lower_y, lower_y + 2 * constants::FIXED_VIEW_HEIGHT,
+                                         left_x, left_x + 2 * constants::FIXED_VIEW_WIDTH);
+            std::vector<std::shared_ptr<GameObject>> visible;
+            for (auto& obj : neighbors) {
+                if (obj != player) visible.push_back(obj);
+            }
+
+            buffer.clear();
+            msgpack::packer<msgpack::sbuffer> pk(&buffer);
+            pk.pack_map(BatchUpdate::kFieldCount);
+            schema::PackKey(pk, BatchUpdate::Key(BatchUpdate::Field::message_type)); pk.pack("batch_update");
+            schema::PackKey(pk, BatchUpdate::Key(BatchUpdate::Field::timestamp)); pk.pack(now);
+            world[i].interest.PackDelta(pk, visible, now);
+            schema::PackKey(pk, BatchUpdate::Key(BatchUpdate::Field::events)); pk.pack_array(0);
+            frame.assign(buffer.data(), buffer.size());
+            if (tick > 0) pack_ms += ThreadCpuMs() - cpu_start;
+            on_frame(tick, i, frame);
+        }
+    }
+    return pack_ms / std::max(ticks - 1, 1);
+}
+
+struct PolicyState {
+    std::unique_ptr<Deflater> shared;
+    std::vector<std::unique_ptr<Deflater>> dedicated;
+    size_t bytes_in = 0, bytes_out = 0;
+    double cpu_ms = 0;
+};
+
+void RunPolicies(int clients, int ticks) {
+    std::vector<Policy> policies = {{"off", false, 0, 0, 0}};
+    for (size_t threshold : {size_t(0), size_t(1024), size_t(8192)}) {
+        std::string suffix = " >=" + std::to_string(threshold) + "B";
+        policies.push_back({"shared" + suffix, false, 15, 8, threshold});
+        policies.push_back({"dedicated-4KB" + suffix, true, 9, 2, threshold});
+        policies.push_back({"dedicated-32KB" + suffix, true, 12, 5, threshold});
+        policies.push_back({"dedicated-256KB" + suffix, true, 15, 8, threshold});
+    }
+
+    std::vector<PolicyState> states(policies.size());
+    for (size_t p = 0; p < policies.size(); p++) {
+        const auto& policy = policies[p];
+        if (policy.window_bits && !policy.dedicated) {
+            states[p].shared = std::make_unique<Deflater>(policy.window_bits, policy.mem_level);
+        }
+        if (policy.dedicated) {
+            for (int i = 0; i < clients; i++) {
+                states[p].dedicated.push_back(std::make_unique<Deflater>(policy.window_bits, policy.mem_level));
+            }
+        }
+    }
+
+    double pack_ms = SimulateFrames(clients, ticks, [&](int tick, int client, const std::string& frame) {
+        for (size_t p = 0; p < policies.size(); p++) {
+            const auto& policy = policies[p];
+            auto& state = states[p];
+            double cpu_start = ThreadCpuMs();
+            size_t out = frame.size();
+            if (policy.window_bits && frame.size() >= policy.threshold) {
+                out = policy.dedicated ? state.dedicated[client]->Compress(frame, false)
+                                       : state.shared->Compress(frame, true);
+            }
+            // The first tick is all spawns; report steady state only
+            if (tick > 0) {
+                state.cpu_ms += ThreadCpuMs() - cpu_start;
+                state.bytes_in += frame.size();
+                state.bytes_out += out;
+            }
+        }
+    });
+
+    int measured = std::max(ticks - 1, 1);
+    std::cout << "\n" << clients << " clients, " << measured << " steady-state ticks"
+              << " (packing: " << std::fixed << std::setprecision(2) << pack_ms << " ms CPU/tick)\n";
+    std::cout << std::left << std::setw(26) << "Policy"
+              << std::right << std::setw(14) << "In(KB/tick)"
+              << std::setw(14) << "Out(KB/tick)"
+              << std::setw(10) << "Saved"
+              << std::setw(16) << "CPU(ms/tick)"
+              << std::setw(16) << "CPU(us/client)" << "\n";
+    std::cout << std::string(96, '-') << "\n";
+
+    for (size_t p = 0; p < policies.size(); p++) {
+        const auto& state = states[p];
+        std::cout << std::left << std::setw(26) << policies[p].name
+                  << std::right << std::setw(14) << std::setprecision(1) << state.bytes_in / 1024.0 / measured
+                  << std::setw(14) << state.bytes_out / 1024.0 / measured
+                  << std::setw(9) << std::setprecision(1)
+                  << (state.bytes_in ? 100.0 * (1.0 - double(state.bytes_out) / state.bytes_in) : 0.0) << "%"
+                  << std::setw(16) << std::setprecision(2) << state.cpu_ms / measured
+                  << std::setw(16) << std::setprecision(1) << state.cpu_ms * 1000.0 / measured / clients << "\n";
+    }
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    std::vector<int> client_counts = {100, 500};
+    if (argc > 1) {
+        client_counts.clear();
+        std::stringstream list(argv[1]);
+        for (std::string item; std::getline(list, item, ',');) client_counts.push_back(std::stoi(item));
+    }
+    int ticks = argc > 2 ? std::stoi(argv[2]) + 1 : 6;
+
+    std::cout << "permessage-deflate benchmark (zlib " << zlibVersion() << ")\n";
+    for (int clients : client_counts) RunPolicies(clients, ticks);
+    return 0;
+}
@@ -4,6 +4,7 @@
 import ws from 'k6/ws';
 import { check } from 'k6';
 import { Counter, Trend } from 'k6/metrics';
+import { ClientMessage, PongMessage, encode, decode } from './schema.js';
 
 // Custom metrics
 const messagesReceived = new Counter('messages_received');
@@ -57,15 +58,15 @@ export default function () {
             console.log(`[${playerId}] Connected to server`);
             
             // Send join message
-            const joinMsg = {
+            const joinMsg = encode(ClientMessage, {
                 type: 'join',
                 id: playerId,
                 username: `Player_${__VU}`,
                 position: { x: playerX, y: playerY },
                 health: 100,
                 size: 20,
-                timeUpdate: Date.now()
-            };
+                time_update: Date.now()
+            });
             socket.send(JSON.stringify(joinMsg));
 
             // Simulate realistic gameplay
@@ -76,13 +77,13 @@ export default function () {
                 playerX = randomMovement(playerX, 1600, 3);
                 playerY = randomMovement(playerY, 1600, 3);
                 
-                const moveMsg = {
+                const moveMsg = encode(ClientMessage, {
                     type: 'movement',
-                    objectType: 'player',
+                    object_type: 'player',
                     id: playerId,
                     position: { x: playerX, y: playerY },
-                    timeUpdate: now
-                };
+                    time_update: now
+                });
                 socket.send(JSON.stringify(moveMsg));
                 
                 // 2. Randomly throw snowballs (30% chance each update)
@@ -90,9 +91,9 @@ export default function () {
                     const angle = Math.random() * 2 * Math.PI;
                     const speed = 200 + Math.random() * 100; // 200-300 speed
                     
-                    const snowballMsg = {
+                    const snowballMsg = encode(ClientMessage, {
                         type: 'movement',
-                        objectType: 'snowball',
+                        object_type: 'snowball',
                         id: `snowball_${playerId}_${snowballCounter++}`,
                         position: { x: playerX, y: playerY },
                         velocity: {
@@ -102,19 +103,19 @@ export default function () {
                         size: 5,
                         damage: 10,
                         charging: false,
-                        lifeLength: 5000,
-                        timeUpdate: now
-                    };
+                        life_length: 5000,
+                        time_update: now
+                    });
                     socket.send(JSON.stringify(snowballMsg));
                 }
                 
                 // 3. Send ping periodically (every 3rd update)
                 if (Math.random() < 0.33) {
                     const pingTime = Date.now();
-                    socket.send(JSON.stringify({
+                    socket.send(JSON.stringify(encode(ClientMessage, {
                         type: 'ping',
-                        clientTime: pingTime
-                    }));
+                        client_time: pingTime
+                    })));
                 }
             }, 100); // Update every 100ms (10 updates per second)
         });
@@ -122,12 +123,16 @@ export default function () {
         socket.on('message', (data) => {
             messagesReceived.add(1);
             
+            // batch_update frames are binary msgpack; only pong is JSON text
+            if (typeof data !== 'string') return;
+
             try {
                 const msg = JSON.parse(data);
                 const now = Date.now();
                 
-                if (msg.messageType === 'pong') {
-                    const latency = now - msg.clientTime;
+                const pong = decode(PongMessage, msg);
+                if (pong.message_type === 'pong') {
+                    const latency = now - pong.client_time;
                     pingLatency.add(latency);
                 } else {
                     // Track general message latency based on timeUpdate
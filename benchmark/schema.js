@@ -0,0 +1,112 @@
+// Generated by benchmark/schema_gen.cpp from src/message_schema.h. Do not edit;
+// run `make schema` after changing a message table.
+//
+// fields maps each member name to its wire key; order is the position of each
+// member in msgpack array encodings (spawns, updates, events).
+
+export const Vec2 = {
+    fields: {
+        x: 'x',
+        y: 'y',
+    },
+    order: ['x', 'y'],
+};
+
+export const ClientMessage = {
+    fields: {
+        type: 'type',
+        id: 'id',
+        username: 'username',
+        object_type: 'objectType',
+        position: 'position',
+        velocity: 'velocity',
+        health: 'health',
+        size: 'size',
+        time_update: 'timeUpdate',
+        life_length: 'lifeLength',
+        damage: 'damage',
+        charging: 'charging',
+        client_time: 'clientTime',
+        snapshot_codec: 'snapshotCodec',
+    },
+    order: ['type', 'id', 'username', 'object_type', 'position', 'velocity', 'health', 'size', 'time_update', 'life_length', 'damage', 'charging', 'client_time', 'snapshot_codec'],
+};
+
+export const PongMessage = {
+    fields: {
+        message_type: 'messageType',
+        server_time: 'serverTime',
+        client_time: 'clientTime',
+    },
+    order: ['message_type', 'server_time', 'client_time'],
+};
+
+export const BatchUpdate = {
+    fields: {
+        message_type: 'messageType',
+        timestamp: 'timestamp',
+        spawns: 'spawns',
+        updates: 'updates',
+        despawns: 'despawns',
+        events: 'events',
+    },
+    order: ['message_type', 'timestamp', 'spawns', 'updates', 'despawns', 'events'],
+};
+
+export const SpawnEntry = {
+    fields: {
+        slot: 'slot',
+        id: 'id',
+        object_type: 'objectType',
+        username: 'username',
+        size: 'size',
+    },
+    order: ['slot', 'id', 'object_type', 'username', 'size'],
+};
+
+export const UpdateEntry = {
+    fields: {
+        slot: 'slot',
+        x: 'x',
+        y: 'y',
+        vx: 'vx',
+        vy: 'vy',
+        charging: 'charging',
+        expire_date: 'expireDate',
+        is_dead: 'isDead',
+        time_update: 'timeUpdate',
+        health: 'newHealth',
+    },
+    order: ['slot', 'x', 'y', 'vx', 'vy', 'charging', 'expire_date', 'is_dead', 'time_update', 'health'],
+};
+
+export const GameEvent = {
+    fields: {
+        type: 'type',
+        health: 'newHealth',
+        damage: 'damage',
+        time: 'timeUpdate',
+    },
+    order: ['type', 'health', 'damage', 'time'],
+};
+
+// Builds a wire object from member-named values, e.g.
+// encode(ClientMessage, { type: 'ping', client_time: Date.now() }).
+export function encode(message, values) {
+    const out = {};
+    for (const [member, value] of Object.entries(values)) {
+        const key = message.fields[member];
+        if (key === undefined) throw new Error(`unknown field ${member}`);
+        out[key] = value;
+    }
+    return out;
+}
+
+// Reads a wire object back into member names; unknown keys are dropped.
+export function decode(message, wire) {
+    const out = {};
+    for (const [member, key] of Object.entries(message.fields)) {
+        if (key in wire) out[member] = wire[key];
+    }
+    return out;
+}
@@ -0,0 +1,62 @@
+// Emits benchmark/schema.js from the message tables in src/message_schema.h so
+// the load-test client uses the same wire keys as the server.
+// Regenerate with: make schema
+
+#include <iostream>
+#include <string_view>
+
+#include "message_schema.h"
+
+namespace {
+
+template <schema::Message T>
+void Emit(std::ostream& out, std::string_view name) {
+    out << "export const " << name << " = {\n    fields: {\n";
+    for (const auto& field : T::kFields) {
+        out << "        " << field.member << ": '" << field.key << "',\n";
+    }
+    out << "    },\n    order: [";
+    for (size_t i = 0; i < T::kFieldCount; i++) {
+        out << (i ? ", " : "") << "'" << T::kFields[i].member << "'";
+    }
+    out << "],\n};\n\n";
+}
+
+}
+
+int main() {
+    std::cout << "// Generated by benchmark/schema_gen.cpp from src/message_schema.h. Do not edit;\n"
+              << "// run `make schema` after changing a message table.\n"
+              << "//\n"
+              << "// fields maps each member name to its wire key; order is the position of each\n"
+              << "// member in msgpack array encodings (spawns, updates, events).\n\n";
+
+    Emit<Vec2>(std::cout, "Vec2");
+    Emit<ClientMessage>(std::cout, "ClientMessage");
+    Emit<PongMessage>(std::cout, "PongMessage");
+    Emit<BatchUpdate>(std::cout, "BatchUpdate");
+    Emit<SpawnEntry>(std::cout, "SpawnEntry");
+    Emit<UpdateEntry>(std::cout, "UpdateEntry");
+    Emit<GameEvent>(std::cout, "GameEvent");
+
+    std::cout << "// Builds a wire object from member-named values, e.g.\n"
+              << "// encode(ClientMessage, { type: 'ping', client_time: Date.now() }).\n"
+              << "export function encode(message, values) {\n"
+              << "    const out = {};\n"
+              << "    for (const [member, value] of Object.entries(values)) {\n"
+              << "        const key = message.fields[member];\n"
+              << "        if (key === undefined) throw new Error(`unknown field ${member}`);\n"
+              << "        out[key] = value;\n"
+              << "    }\n"
+              << "    return out;\n"
+              << "}\n\n"
+              << "// Reads a wire object back into member names; unknown keys are dropped.\n"
+              << "export function decode(message, wire) {\n"
+              << "    const out = {};\n"
+              << "    for (const [member, key] of Object.entries(message.fields)) {\n"
+              << "        if (key in wire) out[member] = wire[key];\n"
+              << "    }\n"
+              << "    return out;\n"
+              << "}\n";
+    return 0;
+}
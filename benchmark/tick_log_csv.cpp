@@ -0,0 +1,69 @@
+// Converts a tick log written with --tick-log (src/tick_log.h) to CSV, oldest
+// tick first. Safe on a log the server is still writing.
+// Build and run with: make tick-log-csv && ./build/tick_log_csv ticks-worker-0.bin > ticks.csv
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include "tick_log.h"
+
+int main(int argc, char *argv[]) {
+    if (argc != 2) {
+        std::cerr << "Usage: " << argv[0] << " <tick log file>" << std::endl;
+        return 1;
+    }
+    int fd = open(argv[1], O_RDONLY);
+    struct stat st = {};
+    if (fd < 0 || fstat(fd, &st) != 0) {
+        std::cerr << "Cannot open " << argv[1] << ": " << std::strerror(errno) << std::endl;
+        return 1;
+    }
+    size_t size = static_cast<size_t>(st.st_size);
+    void *mapped = size >= sizeof(TickLogHeader) ? mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+    close(fd);
+    if (mapped == MAP_FAILED) {
+        std::cerr << argv[1] << " is not a tick log" << std::endl;
+        return 1;
+    }
+
+    const auto *header = static_cast<const TickLogHeader *>(mapped);
+    const auto *slots = reinterpret_cast<const TickRecord *>(header + 1);
+    if (std::memcmp(header->magic, TickLogHeader::kMagic, sizeof(header->magic)) != 0 ||
+        header->record_size != sizeof(TickRecord) || header->capacity == 0 ||
+        sizeof(TickLogHeader) + header->capacity * sizeof(TickRecord) > size) {
+        std::cerr << argv[1] << " is not a tick log of this version" << std::endl;
+        return 1;
+    }
+
+    // Copy first, then drop the records the server may have overwritten during
+    // the copy (at least the oldest one, whose slot the next tick reuses)
+    uint64_t capacity = header->capacity;
+    uint64_t head = header->head.load(std::memory_order_acquire);
+    uint64_t begin = head > capacity ? head - capacity : 0;
+    std::vector<TickRecord> records;
+    records.reserve(head - begin);
+    for (uint64_t i = begin; i < head; i++) {
+        records.push_back(slots[i % capacity]);
+    }
+    uint64_t after = header->head.load(std::memory_order_acquire);
+    size_t skip = after >= capacity + begin ? std::min<uint64_t>(after - capacity - begin + 1, records.size()) : 0;
+
+    std::cout << "tick,unix_us,duration_us,input_us,views_us,objects_us,clients,objects,"
+                 "bytes_sent,grid_ops,lock_wait_us,degradation_level\n";
+    for (size_t i = skip; i < records.size(); i++) {
+        const TickRecord& r = records[i];
+        std::cout << r.tick << ',' << r.unix_us << ',' << r.duration_us << ',' << r.input_us << ','
+                  << r.views_us << ',' << r.objects_us << ',' << r.clients << ',' << r.objects << ','
+                  << r.bytes_sent << ',' << r.grid_ops << ',' << r.lock_wait_us << ','
+                  << r.degradation_level << '\n';
+    }
+    munmap(mapped, size);
+    return 0;
+}
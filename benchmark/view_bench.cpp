@@ -0,0 +1,157 @@
+// Parallel snapshot build benchmark: one worker's client views per tick, built
+// serially and then across a TaskPool of 2..N threads (the --view-threads path).
+// Build and run with: make bench SANITIZER_FLAGS= && ./build/view_bench [clients] [ticks] [max_threads]
+//
+// Each client's build is what BuildPlayerView does: a grid search over the
+// view box, filtering, and an InterestSet delta packed as msgpack. Players
+// jitter and snowballs move between ticks (outside the timed section).
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <thread>
+
+#include "constants.h"
+#include "game_object.h"
+#include "grid.h"
+#include "interest_set.h"
+#include "task_pool.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Client {
+    std::shared_ptr<Player> player;
+    InterestSet interest;
+};
+
+struct World {
+    Grid grid{1600, 1600, 100};
+    std::vector<Client> clients;
+    std::vector<std::shared_ptr<Snowball>> snowballs;
+};
+
+constexpr long long kStart = 1731400000000LL;
+
+void Populate(World& world, int clients, int snowballs_per_client) {
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<double> pos(0, 1599), speed(-300, 300);
+    world.clients.resize(clients);
+    for (int i = 0; i < clients; i++) {
+        auto player = std::make_shared<Player>();
+        player->set_type("player");
+        player->set_id("player_" + std::to_string(i) + "_1731400000000");
+        player->set_username("Player_" + std::to_string(i));
+        player->set_size(20);
+        player->set_x(pos(rng));
+        player->set_y(pos(rng));
+        player->set_life_length(static_cast<long long>(4e18));
+        world.grid.Insert(player);
+        world.clients[i].player = player;
+
+        for (int s = 0; s < snowballs_per_client; s++) {
+            auto snowball = std::make_shared<Snowball>("snowball_" + player->get_id() + "_" + std::to_string(s), "snowball");
+            snowball->set_x(pos(rng));
+            snowball->set_y(pos(rng));
+            snowball->set_vx(speed(rng));
+            snowball->set_vy(speed(rng));
+            snowball->set_size(5);
+            snowball->set_time_update(kStart);
+            snowball->set_life_length(static_cast<long long>(4e18));
+            world.grid.Insert(snowball);
+            world.snowballs.push_back(snowball);
+        }
+    }
+}
+
+void Step(World& world, long long now, std::mt19937& rng) {
+    std::uniform_real_distribution<double> step(-3, 3);
+    for (auto& client : world.clients) {
+        client.player->set_x(std::clamp(client.player->get_x() + step(rng), 0.0, 1599.0));
+        client.player->set_y(std::clamp(client.player->get_y() + step(rng), 0.0, 1599.0));
+        world.grid.Update(client.player, 0);
+    }
+    for (auto& snowball : world.snowballs) world.grid.Update(snowball, now);
+}
+
+void BuildView(World& world, Client& client, long long now, std::string& frame) {
+    thread_local msgpack::sbuffer buffer;
+    thread_local std::vector<std::shared_ptr<GameObject>> visible;
+    auto& player = client.player;
+    double lower_y = player->get_y() - constants::FIXED_VIEW_HEIGHT;
+    double left_x = player->get_x() - constants::FIXED_VIEW_WIDTH;
+    auto neighbors = world.grid.Search(lower_y, lower_y + 2 * constants::FIXED_VIEW_HEIGHT,
+                                       left_x, left_x + 2 * constants::FIXED_VIEW_WIDTH);
+    visible.clear();
+    for (auto& obj : neighbors) {
+        if (obj != player) visible.push_back(obj);
+    }
+
+    buffer.clear();
+    msgpack::packer<msgpack::sbuffer> pk(&buffer);
+    pk.pack_map(BatchUpdate::kFieldCount);
+    schema::PackKey(pk, BatchUpdate::Key(BatchUpdate::Field::message_type)); pk.pack("batch_update");
+    schema::PackKey(pk, BatchUpdate::Key(BatchUpdate::Field::timestamp)); pk.pack(now);
+    client.interest.PackDelta(pk, visible, now);
+    schema::PackKey(pk, BatchUpdate::Key(BatchUpdate::Field::events)); pk.pack_array(0);
+    frame.assign(buffer.data(), buffer.size());
+}
+
+// Mean wall time per tick (ms) to build every client's frame.
+double Run(int clients, int ticks, int threads) {
+    World world;
+    Populate(world, clients, 3);
+    std::unique_ptr<TaskPool> pool;
+    if (threads > 1) pool = std::make_unique<TaskPool>(threads - 1);  // Plus the calling thread
+
+    std::mt19937 rng(11);
+    std::vector<std::string> frames(clients);
+    double total_ms = 0;
+    for (int tick = 0; tick <= ticks; tick++) {
+        long long now = kStart + tick * 10;
+        Step(world, now, rng);
+
+        auto start = Clock::now();
+        auto build = [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) BuildView(world, world.clients[i], now, frames[i]);
+        };
+        if (pool) pool->ParallelFor(frames.size(), 4, build);
+        else build(0, frames.size());
+        double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+        if (tick > 0) total_ms += ms;  // First tick is all spawns
+    }
+    return total_ms / ticks;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    int clients = argc > 1 ? std::stoi(argv[1]) : 200;
+    int ticks = argc > 2 ? std::stoi(argv[2]) : 200;
+    int max_threads = argc > 3 ? std::stoi(argv[3])
+                               : std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+
+    std::cout << "Parallel view build: " << clients << " clients, " << clients * 3
+              << " snowballs, " << ticks << " ticks\n\n"
+              << std::left << std::setw(10) << "threads" << std::right << std::setw(14) << "ms/tick"
+              << std::setw(12) << "speedup" << std::setw(14) << "efficiency" << "\n";
+
+    double serial_ms = 0;
+    std::vector<int> thread_counts;
+    for (int threads = 1; threads < max_threads; threads *= 2) thread_counts.push_back(threads);
+    thread_counts.push_back(max_threads);
+
+    for (int threads : thread_counts) {
+        double ms = Run(clients, ticks, threads);
+        if (threads == 1) serial_ms = ms;
+        double speedup = serial_ms / ms;
+        std::cout << std::left << std::setw(10) << threads << std::right << std::fixed << std::setprecision(3)
+                  << std::setw(14) << ms << std::setprecision(2) << std::setw(11) << speedup << "x"
+                  << std::setw(13) << speedup / threads * 100 << "%\n";
+    }
+    return 0;
+}
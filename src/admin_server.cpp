@@ -0,0 +1,62 @@
+#include "admin_server.h"
+
+#include <uWebSockets/App.h>
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <shared_mutex>
+#include <string_view>
+
+#include "metrics.h"
+#include "connection_stats.h"
+#include "constants.h"
+
+extern std::shared_mutex output_mtx;
+
+void AdminServer::Start(std::string address, int port) {
+    thread_ = std::thread(&AdminServer::Run, this, std::move(address), port);
+}
+
+void AdminServer::Run(std::string address, int port) {
+    uWS::App()
+    .get("/metrics", [](auto *res, auto * /*req*/) {
+        // Rendered by the report loop in main; serving it is a copy
+        auto text = MetricsExporter::instance().Current();
+        res->writeHeader("Content-Type", "text/plain; version=0.0.4")->end(*text);
+    })
+    // Worst connections as JSON: /clients?sort=rtt|buffered|dropped|bytes_out&limit=N
+    .get("/clients", [](auto *res, auto *req) {
+        auto order = ConnectionStatsBoard::Order::kRtt;
+        std::string_view sort = req->getQuery("sort");
+        if (!sort.empty() && !ConnectionStatsBoard::ParseOrder(sort, order)) {
+            res->writeStatus("400 Bad Request")->end("sort must be rtt, buffered, dropped or bytes_out\n");
+            return;
+        }
+        size_t limit = 50;
+        std::string_view limit_arg = req->getQuery("limit");
+        if (!limit_arg.empty()) {
+            limit = 0;
+            for (char c : limit_arg) {
+                if (c < '0' || c > '9') {
+                    res->writeStatus("400 Bad Request")->end("limit must be a number\n");
+                    return;
+                }
+                // Larger limits are capped, not refused
+                limit = std::min<size_t>(limit * 10 + (c - '0'), constants::MAX_CLIENTS_LISTED);
+            }
+        }
+        res->writeHeader("Content-Type", "application/json")
+           ->end(ConnectionStatsBoard::ToJson(connection_stats->Worst(order, limit)));
+    })
+    .listen(address, port, [&](auto *listenSocket) {
+        std::unique_lock<std::shared_mutex> lock(output_mtx);
+        if (listenSocket) {
+            std::cout << "Serving /metrics and /clients on http://" << address << ":" << port << std::endl;
+        } else {
+            std::cerr << "Failed to serve /metrics and /clients on " << address << ":" << port << ": "
+                      << std::strerror(errno) << std::endl;
+        }
+    })
+    .run();
+}
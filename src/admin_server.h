@@ -0,0 +1,27 @@
+#ifndef ADMIN_SERVER_H
+#define ADMIN_SERVER_H
+
+#include <string>
+#include <thread>
+
+// Plain-HTTP listener for operators, kept off the public game port:
+// GET /metrics for Prometheus and GET /clients for the worst connections.
+//
+// It runs its own uWS loop on its own thread, so a scrape (and the sort and
+// JSON of /clients) never runs on a game loop, and listens on --metrics-address (loopback by default) so game
+// clients cannot reach it.
+class AdminServer {
+public:
+    AdminServer() = default;
+    AdminServer(const AdminServer&) = delete;
+    AdminServer& operator=(const AdminServer&) = delete;
+
+    void Start(std::string address, int port);
+
+private:
+    void Run(std::string address, int port);
+
+    std::thread thread_;
+};
+
+#endif
@@ -0,0 +1,126 @@
+#ifndef BIT_STREAM_H
+#define BIT_STREAM_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Appends values of arbitrary bit width, least significant bit first.
+class BitWriter {
+public:
+    void Clear() {
+        bytes_.clear();
+        scratch_ = 0;
+        scratch_bits_ = 0;
+    }
+
+    // Writes the low `bits` bits of value (bits <= 32).
+    void Write(uint32_t value, int bits) {
+        if (bits < 32) value &= (1u << bits) - 1;
+        scratch_ |= static_cast<uint64_t>(value) << scratch_bits_;
+        scratch_bits_ += bits;
+        while (scratch_bits_ >= 8) {
+            bytes_.push_back(static_cast<uint8_t>(scratch_));
+            scratch_ >>= 8;
+            scratch_bits_ -= 8;
+        }
+    }
+
+    void WriteSigned(int32_t value, int bits) { Write(static_cast<uint32_t>(value), bits); }
+    void WriteBool(bool value) { Write(value ? 1 : 0, 1); }
+
+    void Write64(uint64_t value, int bits) {
+        if (bits > 32) {
+            Write(static_cast<uint32_t>(value), 32);
+            Write(static_cast<uint32_t>(value >> 32), bits - 32);
+        } else {
+            Write(static_cast<uint32_t>(value), bits);
+        }
+    }
+
+    // Length-prefixed (8 bits) byte string, truncated to 255 bytes.
+    void WriteString(std::string_view str) {
+        size_t len = std::min<size_t>(str.size(), 255);
+        Write(static_cast<uint32_t>(len), 8);
+        for (size_t i = 0; i < len; i++) Write(static_cast<uint8_t>(str[i]), 8);
+    }
+
+    // Pads the final partial byte with zeros.
+    void Flush() {
+        if (scratch_bits_ > 0) {
+            bytes_.push_back(static_cast<uint8_t>(scratch_));
+            scratch_ = 0;
+            scratch_bits_ = 0;
+        }
+    }
+
+    [[nodiscard]] const uint8_t* data() const { return bytes_.data(); }
+    [[nodiscard]] size_t size() const { return bytes_.size(); }
+    [[nodiscard]] size_t bit_size() const { return bytes_.size() * 8 + scratch_bits_; }
+
+private:
+    std::vector<uint8_t> bytes_;
+    uint64_t scratch_ = 0;
+    int scratch_bits_ = 0;
+};
+
+// Reads back what BitWriter produced. Reading past the end yields zeros and
+// sets overflowed().
+class BitReader {
+public:
+    BitReader(const uint8_t* data, size_t size) : data_(data), size_(size) {}
+
+    uint32_t Read(int bits) {
+        while (scratch_bits_ < bits) {
+            uint64_t byte = 0;
+            if (pos_ < size_) byte = data_[pos_];
+            else overflowed_ = true;
+            pos_++;
+            scratch_ |= byte << scratch_bits_;
+            scratch_bits_ += 8;
+        }
+        uint32_t value = static_cast<uint32_t>(scratch_ & ((bits < 32 ? (1ull << bits) : (1ull << 32)) - 1));
+        scratch_ >>= bits;
+        scratch_bits_ -= bits;
+        return value;
+    }
+
+    // Sign-extends a two's complement value of the given width.
+    int32_t ReadSigned(int bits) {
+        uint32_t value = Read(bits);
+        if (bits < 32 && (value & (1u << (bits - 1)))) value |= ~((1u << bits) - 1);
+        return static_cast<int32_t>(value);
+    }
+
+    bool ReadBool() { return Read(1) != 0; }
+
+    uint64_t Read64(int bits) {
+        if (bits > 32) {
+            uint64_t low = Read(32);
+            return low | (static_cast<uint64_t>(Read(bits - 32)) << 32);
+        }
+        return Read(bits);
+    }
+
+    std::string ReadString() {
+        uint32_t len = Read(8);
+        std::string str(len, '\0');
+        for (uint32_t i = 0; i < len; i++) str[i] = static_cast<char>(Read(8));
+        return str;
+    }
+
+    [[nodiscard]] bool overflowed() const { return overflowed_; }
+
+private:
+    const uint8_t* data_;
+    size_t size_;
+    size_t pos_ = 0;
+    uint64_t scratch_ = 0;
+    int scratch_bits_ = 0;
+    bool overflowed_ = false;
+};
+
+#endif
@@ -0,0 +1,107 @@
+#ifndef CLIENT_REGISTRY_H
+#define CLIENT_REGISTRY_H
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Dense set of one thread's client sockets.
+//
+// Sockets live in a contiguous vector and each one's index is kept in its
+// user data (registry_slot), so Add and Remove are O(1) (Remove swaps the last
+// socket into the hole). ForEach walks the vector in place: sockets removed
+// while it runs (a close callback fired from a send, a dead player) are only
+// nulled out and compacted afterwards, and sockets added are appended and
+// picked up on the next pass. Owned by a single thread.
+template <typename Socket>
+class ClientRegistry {
+public:
+    static constexpr uint32_t kNoSlot = UINT32_MAX;
+
+    void Add(Socket *ws) {
+        auto *user_data = ws->getUserData();
+        if (user_data->registry_slot != kNoSlot) return;
+        user_data->registry_slot = static_cast<uint32_t>(slots_.size());
+        slots_.push_back(ws);
+        count_++;
+    }
+
+    // Safe to call for a socket that is not registered.
+    void Remove(Socket *ws) {
+        auto *user_data = ws->getUserData();
+        uint32_t slot = user_data->registry_slot;
+        if (slot == kNoSlot) return;
+        user_data->registry_slot = kNoSlot;
+        count_--;
+
+        if (iterating_) {
+            slots_[slot] = nullptr;  // Compacted when the pass ends
+            return;
+        }
+        Socket *last = slots_.back();
+        slots_.pop_back();
+        if (last != ws) {
+            slots_[slot] = last;
+            last->getUserData()->registry_slot = slot;
+        }
+    }
+
+    [[nodiscard]] bool Contains(Socket *ws) const {
+        return ws->getUserData()->registry_slot != kNoSlot;
+    }
+
+    [[nodiscard]] size_t size() const { return count_; }
+    [[nodiscard]] bool empty() const { return count_ == 0; }
+
+    // Calls fn(ws) for every registered socket; fn may Add or Remove any socket.
+    template <typename Fn>
+    void ForEach(Fn &&fn) {
+        bool outer = !iterating_;
+        iterating_ = true;
+        size_t end = slots_.size();  // Sockets added during the pass wait for the next one
+        for (size_t i = 0; i < end; i++) {
+            if (Socket *ws = slots_[i]) fn(ws);
+        }
+        if (outer) {
+            iterating_ = false;
+            if (slots_.size() != count_) Compact();
+        }
+    }
+
+    // Reorders sockets by key(ws) (e.g. the player's grid cell), so a pass
+    // visits neighbours back to back and their cells and objects are still
+    // in cache. Not during ForEach.
+    template <typename Key>
+    void SortBy(Key &&key) {
+        if (iterating_) return;
+        keyed_.clear();
+        keyed_.reserve(slots_.size());
+        for (Socket *ws : slots_) keyed_.emplace_back(key(ws), ws);
+        std::stable_sort(keyed_.begin(), keyed_.end(),
+                         [](const auto &a, const auto &b) { return a.first < b.first; });
+        for (size_t i = 0; i < keyed_.size(); i++) {
+            slots_[i] = keyed_[i].second;
+            slots_[i]->getUserData()->registry_slot = static_cast<uint32_t>(i);
+        }
+    }
+
+private:
+    // Closes the holes left by removals during ForEach, keeping the order.
+    void Compact() {
+        size_t out = 0;
+        for (Socket *ws : slots_) {
+            if (!ws) continue;
+            ws->getUserData()->registry_slot = static_cast<uint32_t>(out);
+            slots_[out++] = ws;
+        }
+        slots_.resize(out);
+    }
+
+    std::vector<Socket *> slots_;
+    std::vector<std::pair<long long, Socket *>> keyed_;  // SortBy scratch
+    size_t count_ = 0;
+    bool iterating_ = false;
+};
+
+#endif
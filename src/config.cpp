@@ -0,0 +1,137 @@
+#include "config.h"
+
+#include <iostream>
+#include <string>
+#include <string_view>
+
+namespace {
+    bool ParseInt(std::string_view name, const std::string& value, long long min, long long max, long long& out) {
+        try {
+            size_t used = 0;
+            out = std::stoll(value, &used);
+            if (used == value.size() && out >= min && out <= max) return true;
+        } catch (const std::exception&) {
+        }
+        std::cerr << "Error: " << name << " must be an integer between " << min << " and " << max
+                  << " (got '" << value << "')" << std::endl;
+        return false;
+    }
+}
+
+bool ParseServerConfig(int argc, char *argv[], ServerConfig& config) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        long long number = 0;
+
+        // Bare first argument is the port, as before
+        if (arg.rfind("--", 0) != 0) {
+            if (i != 1) {
+                std::cerr << "Error: Unexpected argument '" << arg << "'" << std::endl;
+                return false;
+            }
+            if (!ParseInt("Port", arg, 1, 65535, number)) return false;
+            config.port = static_cast<int>(number);
+            continue;
+        }
+
+        size_t eq = arg.find('=');
+        std::string key = arg.substr(2, eq == std::string::npos ? std::string::npos : eq - 2);
+        std::string value = eq == std::string::npos ? "" : arg.substr(eq + 1);
+
+        if (key == "port") {
+            if (!ParseInt("--port", value, 1, 65535, number)) return false;
+            config.port = static_cast<int>(number);
+        } else if (key == "metrics-port") {
+            if (!ParseInt("--metrics-port", value, 0, 65535, number)) return false;
+            config.metrics_port = static_cast<int>(number);
+        } else if (key == "metrics-address") {
+            if (value.empty()) {
+                std::cerr << "Error: --metrics-address needs an address" << std::endl;
+                return false;
+            }
+            config.metrics_address = value;
+        } else if (key == "threading") {
+            if (value == "inline") config.threading = ServerConfig::Threading::kInline;
+            else if (value == "simulation") config.threading = ServerConfig::Threading::kSimulation;
+            else {
+                std::cerr << "Error: --threading must be inline or simulation" << std::endl;
+                return false;
+            }
+        } else if (key == "balance") {
+            if (value == "reuseport") config.balance = ServerConfig::Balance::kReusePort;
+            else if (value == "clients") config.balance = ServerConfig::Balance::kClients;
+            else if (value == "tick") config.balance = ServerConfig::Balance::kTickTime;
+            else {
+                std::cerr << "Error: --balance must be reuseport, clients or tick" << std::endl;
+                return false;
+            }
+        } else if (key == "snapshot-rates") {
+            if (value.empty() || value == "on") config.snapshot_rates = true;
+            else if (value == "off") config.snapshot_rates = false;
+            else {
+                std::cerr << "Error: --snapshot-rates must be on or off" << std::endl;
+                return false;
+            }
+        } else if (key == "snapshot-budget") {
+            if (!ParseInt("--snapshot-budget", value, 0, 1 << 20, number)) return false;
+            config.snapshot_budget = static_cast<size_t>(number);
+        } else if (key == "backpressure-limit") {
+            if (!ParseInt("--backpressure-limit", value, 1024, 64 << 20, number)) return false;
+            config.backpressure_limit = static_cast<size_t>(number);
+        } else if (key == "tick-rate") {
+            if (!ParseInt("--tick-rate", value, 1, 1000, number)) return false;
+            config.tick_rate = static_cast<int>(number);
+        } else if (key == "max-catch-up") {
+            if (!ParseInt("--max-catch-up", value, 0, 100, number)) return false;
+            config.max_catch_up = static_cast<int>(number);
+        } else if (key == "view-threads") {
+            if (!ParseInt("--view-threads", value, 0, 1024, number)) return false;
+            config.view_threads = static_cast<int>(number);
+        } else if (key == "trace-events") {
+            if (!ParseInt("--trace-events", value, 0, 1 << 24, number)) return false;
+            config.trace_events = static_cast<size_t>(number);
+        } else if (key == "cpu-profile-hz") {
+            if (!ParseInt("--cpu-profile-hz", value, 0, 1000, number)) return false;
+            config.cpu_profile_hz = static_cast<int>(number);
+        } else if (key == "tick-log") {
+            if (value.empty()) {
+                std::cerr << "Error: --tick-log needs a directory" << std::endl;
+                return false;
+            }
+            config.tick_log_dir = value;
+        } else if (key == "workers") {
+            if (!ParseInt("--workers", value, 0, 1024, number)) return false;
+            config.workers = static_cast<int>(number);
+        } else if (key == "pin-threads") {
+            if (value.empty() || value == "on") config.pin_threads = true;
+            else if (value == "off") config.pin_threads = false;
+            else {
+                std::cerr << "Error: --pin-threads must be on or off" << std::endl;
+                return false;
+            }
+        } else if (key == "compression") {
+            if (value == "off") config.compression = ServerConfig::Compression::kOff;
+            else if (value == "shared") config.compression = ServerConfig::Compression::kShared;
+            else if (value == "dedicated") config.compression = ServerConfig::Compression::kDedicated;
+            else {
+                std::cerr << "Error: --compression must be off, shared or dedicated" << std::endl;
+                return false;
+            }
+        } else if (key == "compression-window") {
+            if (!ParseInt("--compression-window", value, 3, 256, number)) return false;
+            if (number != 3 && number != 4 && number != 8 && number != 16 &&
+                number != 32 && number != 64 && number != 128 && number != 256) {
+                std::cerr << "Error: --compression-window must be one of 3, 4, 8, 16, 32, 64, 128, 256 (KB)" << std::endl;
+                return false;
+            }
+            config.compression_window_kb = static_cast<int>(number);
+        } else if (key == "compress-threshold") {
+            if (!ParseInt("--compress-threshold", value, 0, 1 << 30, number)) return false;
+            config.compression_threshold = static_cast<size_t>(number);
+        } else {
+            std::cerr << "Error: Unknown option '" << arg << "'" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,73 @@
+#ifndef CONFIG_H
+#define CONFIG_H
+
+#include <cstddef>
+#include <string>
+
+// Runtime settings parsed from the command line.
+// Usage: ./server [port] [--option=value ...]
+struct ServerConfig {
+    enum class Compression { kOff, kShared, kDedicated };
+    enum class Threading { kInline, kSimulation };
+
+    int port = 12345;
+
+    // Plain-HTTP listener for GET /metrics and /clients, separate from the game port;
+    // loopback only unless an address is given. Port 0 = off.
+    std::string metrics_address = "127.0.0.1";
+    int metrics_port = 9464;
+
+    // inline: each worker runs game logic on its own event loop.
+    // simulation: workers only do socket I/O and one thread runs the game.
+    Threading threading = Threading::kInline;
+
+    // Where accepted sockets go: reuseport leaves it to the kernel's hash;
+    // clients / tick move each new socket to the worker with the fewest
+    // clients / the shortest recent client tick.
+    enum class Balance { kReusePort, kClients, kTickTime };
+    Balance balance = Balance::kReusePort;
+
+    // Distance-based snapshot rates: dynamic updates are rationed by priority
+    // (near/fast objects every tick, distant ones less often); off sends every
+    // visible object every tick.
+    bool snapshot_rates = true;
+    // Per-snapshot byte cap on top of the rates, filled most overdue first;
+    // 0 = no cap, the rates alone.
+    size_t snapshot_budget = 8192;
+
+    // Once this many bytes are queued on a socket, its snapshots are skipped
+    // until it drains; the next one carries the newest state, so nothing is lost.
+    size_t backpressure_limit = 64 * 1024;
+
+    int tick_rate = 100;        // Fixed simulation ticks per second
+    int max_catch_up = 4;       // Extra ticks run back to back after a stall; the rest are dropped
+
+    int workers = 0;            // I/O (or I/O + game) worker threads; 0 = one per available CPU
+    bool pin_threads = false;   // Pin each worker to its own CPU and keep its memory on that NUMA node
+    int view_threads = 0;       // Work-stealing pool shared by all game threads for snapshot builds; 0 = build serially
+
+    // Span tracing: the newest N PROFILE_SCOPE/lock events kept per thread
+    // and dumped as Chrome trace JSON on SIGUSR2; 0 = off.
+    size_t trace_events = 0;
+
+    // Directory for per-tick telemetry: each game thread keeps its last
+    // TICK_LOG_SECONDS of ticks in a memory-mapped ring file there; empty = off.
+    std::string tick_log_dir;
+
+    // Sampling CPU profiler: samples per second of each game/I/O thread's CPU
+    // time while a profile runs (kill -USR1 starts and stops one); 0 = off.
+    int cpu_profile_hz = 99;
+
+    // permessage-deflate: shared uses one compressor per thread without
+    // context takeover, dedicated keeps a per-connection sliding window.
+    Compression compression = Compression::kOff;
+    int compression_window_kb = 32;         // Dedicated only: 3, 4, 8, 16, 32, 64, 128 or 256
+    size_t compression_threshold = 1024;    // Frames smaller than this are sent uncompressed
+};
+
+// Returns false (after printing the reason to stderr) on invalid arguments.
+[[nodiscard]] bool ParseServerConfig(int argc, char *argv[], ServerConfig& config);
+
+extern ServerConfig server_config;
+
+#endif
@@ -0,0 +1,85 @@
+#include "connection_balancer.h"
+
+ConnectionBalancer::ConnectionBalancer(int workers, Policy policy)
+    : workers_(workers), policy_(policy), slots_(std::make_unique<Slot[]>(workers)) {}
+
+void ConnectionBalancer::Attach(int worker, Adopt adopt) {
+    slots_[worker].adopt = std::move(adopt);
+    slots_[worker].ready.store(true, std::memory_order_release);
+}
+
+long long ConnectionBalancer::Load(const Slot& slot) const {
+    long long clients = slot.clients.load(std::memory_order_relaxed) +
+                        slot.pending.load(std::memory_order_relaxed) +
+                        slot.unopened.load(std::memory_order_relaxed);
+    if (policy_ == Policy::kTickTime) {
+        // Tick time in 100 us steps so jitter doesn't bounce sockets around;
+        // clients break ties within a step
+        return (slot.tick_us.load(std::memory_order_relaxed) / 100) * 1'000'000 + clients;
+    }
+    return clients;
+}
+
+bool ConnectionBalancer::Route(int from, int fd) {
+    int best = from;
+    long long best_load = Load(slots_[from]);
+    for (int i = 0; i < workers_; i++) {
+        if (i == from || !slots_[i].ready.load(std::memory_order_acquire)) continue;
+        long long load = Load(slots_[i]);
+        if (load < best_load) {
+            best = i;
+            best_load = load;
+        }
+    }
+    if (best == from) return false;
+
+    slots_[best].pending.fetch_add(1, std::memory_order_relaxed);
+    slots_[best].adopt(fd);
+    return true;
+}
+
+void ConnectionBalancer::PublishUnopened(Slot& slot) {
+    slot.unopened.store(slot.fresh + slot.older, std::memory_order_relaxed);
+}
+
+void ConnectionBalancer::Kept(int worker) {
+    Slot& slot = slots_[worker];
+    slot.fresh++;
+    PublishUnopened(slot);
+}
+
+void ConnectionBalancer::Adopted(int worker) {
+    Slot& slot = slots_[worker];
+    // Counted as unopened before it leaves pending, so a Route() in between
+    // never sees the socket missing
+    slot.fresh++;
+    PublishUnopened(slot);
+    slot.pending.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void ConnectionBalancer::ClientOpened(int worker) {
+    Slot& slot = slots_[worker];
+    slot.clients.fetch_add(1, std::memory_order_relaxed);
+    // Oldest first: those are the ones about to expire
+    if (slot.older > 0) slot.older--;
+    else if (slot.fresh > 0) slot.fresh--;
+    PublishUnopened(slot);
+}
+
+void ConnectionBalancer::ClientClosed(int worker) {
+    slots_[worker].clients.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void ConnectionBalancer::ExpireUnopened(int worker) {
+    Slot& slot = slots_[worker];
+    slot.older = slot.fresh;
+    slot.fresh = 0;
+    PublishUnopened(slot);
+}
+
+void ConnectionBalancer::RecordTick(int worker, long long duration_us) {
+    // EWMA over ~8 ticks; only the owning thread writes it
+    auto& tick_us = slots_[worker].tick_us;
+    long long smoothed = tick_us.load(std::memory_order_relaxed);
+    tick_us.store(smoothed + (duration_us - smoothed) / 8, std::memory_order_relaxed);
+}
@@ -0,0 +1,69 @@
+#ifndef CONNECTION_BALANCER_H
+#define CONNECTION_BALANCER_H
+
+#include <atomic>
+#include <functional>
+#include <memory>
+
+// Moves newly accepted sockets to the least-loaded worker.
+//
+// Every worker still listens on the shared port; its preOpen hook asks Route()
+// where the socket should live. If another worker is less loaded the fd is
+// handed to it (the target adopts it on its own loop via Loop::defer) and the
+// accepting loop drops it. Load is the open client count plus hand-offs still
+// in flight plus sockets kept or adopted but not yet upgraded, or with
+// kTickTime the worker's recent client-tick duration.
+//
+// preOpen only sees an fd, so a plain HTTP request on the game port is
+// balanced like a WebSocket; a socket that never upgrades stops counting
+// after one to two ExpireUnopened() periods (CONNECTION_STATS_PERIOD_MS).
+class ConnectionBalancer {
+public:
+    enum class Policy { kClients, kTickTime };
+
+    // Takes ownership of an accepted fd on the worker's own loop.
+    using Adopt = std::function<void(int fd)>;
+
+    ConnectionBalancer(int workers, Policy policy);
+
+    // Worker is ready to receive sockets. Called from the worker's thread.
+    void Attach(int worker, Adopt adopt);
+
+    // Called from `from`'s preOpen. Returns true if the socket was handed to
+    // another worker and `from` must not open it.
+    [[nodiscard]] bool Route(int from, int fd);
+
+    // Bookkeeping, each called on the worker's own thread.
+    void Kept(int worker);          // preOpen kept the socket on this worker
+    void Adopted(int worker);
+    void ClientOpened(int worker);
+    void ClientClosed(int worker);
+    void RecordTick(int worker, long long duration_us);
+    // Periodic: forgets sockets accepted two periods ago that never upgraded.
+    void ExpireUnopened(int worker);
+
+    [[nodiscard]] int workers() const { return workers_; }
+
+private:
+    struct alignas(64) Slot {
+        std::atomic<bool> ready{false};
+        std::atomic<int> clients{0};
+        std::atomic<int> pending{0};       // Handed off but not yet adopted
+        std::atomic<int> unopened{0};      // Accepted here, not yet upgraded: fresh + older
+        int fresh = 0, older = 0;          // Owner thread only: unopened by accept period
+        std::atomic<long long> tick_us{0}; // Smoothed client-tick duration
+        Adopt adopt;                       // Written once before ready
+    };
+
+    [[nodiscard]] long long Load(const Slot& slot) const;
+    static void PublishUnopened(Slot& slot);
+
+    int workers_;
+    Policy policy_;
+    std::unique_ptr<Slot[]> slots_;
+};
+
+// Null when the kernel's SO_REUSEPORT hashing is left in charge.
+extern std::shared_ptr<ConnectionBalancer> balancer;
+
+#endif
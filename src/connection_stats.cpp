@@ -0,0 +1,93 @@
+#include "connection_stats.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <ostream>
+
+#include "nlohmann/json.hpp"
+
+void ConnectionStatsBoard::Publish(int worker, std::vector<ConnectionStats> stats) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    if (static_cast<size_t>(worker) >= workers_.size()) {
+        workers_.resize(worker + 1);
+    }
+    workers_[worker] = std::move(stats);
+}
+
+std::vector<ConnectionStats> ConnectionStatsBoard::Worst(Order order, size_t limit) const {
+    std::vector<ConnectionStats> all;
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        for (const auto& stats : workers_) all.insert(all.end(), stats.begin(), stats.end());
+    }
+    auto worse = [order](const ConnectionStats& a, const ConnectionStats& b) {
+        switch (order) {
+        case Order::kRtt: return a.rtt_us > b.rtt_us;
+        case Order::kBuffered:
+            return a.buffered_bytes != b.buffered_bytes ? a.buffered_bytes > b.buffered_bytes
+                                                        : a.dropped_snapshots > b.dropped_snapshots;
+        case Order::kDropped:
+            return a.dropped_snapshots != b.dropped_snapshots ? a.dropped_snapshots > b.dropped_snapshots
+                                                              : a.buffered_bytes > b.buffered_bytes;
+        case Order::kBytesOut: return a.bytes_out > b.bytes_out;
+        }
+        return false;
+    };
+    limit = std::min(limit, all.size());
+    std::partial_sort(all.begin(), all.begin() + limit, all.end(), worse);
+    all.resize(limit);
+    return all;
+}
+
+bool ConnectionStatsBoard::ParseOrder(std::string_view name, Order& order) {
+    if (name == "rtt") order = Order::kRtt;
+    else if (name == "buffered") order = Order::kBuffered;
+    else if (name == "dropped") order = Order::kDropped;
+    else if (name == "bytes_out") order = Order::kBytesOut;
+    else return false;
+    return true;
+}
+
+std::string ConnectionStatsBoard::ToJson(const std::vector<ConnectionStats>& stats) {
+    nlohmann::json clients = nlohmann::json::array();
+    for (const auto& s : stats) {
+        clients.push_back({
+            {"client_id", s.client_id},
+            {"worker", s.worker},
+            {"connected_s", s.connected_s},
+            {"bytes_in", s.bytes_in},
+            {"messages_in", s.messages_in},
+            {"bytes_out", s.bytes_out},
+            {"messages_out", s.messages_out},
+            {"rtt_us", s.rtt_us},
+            {"buffered_bytes", s.buffered_bytes},
+            {"dropped_snapshots", s.dropped_snapshots},
+            {"backpressured", s.backpressured},
+        });
+    }
+    return nlohmann::json{{"clients", std::move(clients)}}.dump();
+}
+
+void ConnectionStatsBoard::Print(std::ostream& out, size_t limit) const {
+    auto table = [&](const char *title, Order order) {
+        auto worst = Worst(order, limit);
+        if (worst.empty()) return;
+        out << title << "\n"
+            << std::left << std::setw(10) << "Client" << std::setw(8) << "Worker"
+            << std::right << std::setw(12) << "RTT (ms)" << std::setw(14) << "Buffered"
+            << std::setw(10) << "Dropped" << std::setw(14) << "Bytes Out" << std::setw(12) << "Msgs In" << "\n";
+        for (const auto& s : worst) {
+            out << std::left << std::setw(10) << s.client_id << std::setw(8) << s.worker << std::right
+                << std::setw(12) << std::fixed << std::setprecision(1);
+            if (s.rtt_us >= 0) out << s.rtt_us / 1000.0;
+            else out << "-";
+            out << std::setw(14) << s.buffered_bytes << std::setw(10) << s.dropped_snapshots
+                << std::setw(14) << s.bytes_out << std::setw(12) << s.messages_in << "\n";
+        }
+    };
+    if (Worst(Order::kRtt, 1).empty()) return;
+    out << "\n=== WORST CLIENTS ===\n";
+    table("By round trip time:", Order::kRtt);
+    table("By buffered bytes:", Order::kBuffered);
+    out << "=====================\n";
+}
@@ -0,0 +1,60 @@
+#ifndef CONNECTION_STATS_H
+#define CONNECTION_STATS_H
+
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// One connection's counters as last published by its worker.
+struct ConnectionStats {
+    uint64_t client_id = 0;
+    int worker = 0;
+    long long connected_s = 0;      // Age of the connection
+    uint64_t bytes_in = 0;
+    uint64_t messages_in = 0;
+    uint64_t bytes_out = 0;
+    uint64_t messages_out = 0;
+    long long rtt_us = -1;          // Last ping round trip, or how long the current ping has waited if longer; -1 = none yet
+    size_t buffered_bytes = 0;      // Queued on the socket
+    uint64_t dropped_snapshots = 0; // Skipped while backpressured
+    bool backpressured = false;
+};
+
+// Latest per-connection stats of every worker, for GET /clients and the
+// periodic report.
+//
+// Sockets may only be touched on their own loop thread, so each worker
+// gathers its clients' counters on a timer (every
+// CONNECTION_STATS_PERIOD_MS) and publishes the whole list; readers copy it.
+class ConnectionStatsBoard {
+public:
+    enum class Order { kRtt, kBuffered, kDropped, kBytesOut };
+
+    explicit ConnectionStatsBoard(int workers) : workers_(workers) {}
+
+    // Replaces everything `worker` published before.
+    void Publish(int worker, std::vector<ConnectionStats> stats);
+
+    // The `limit` worst connections across all workers, worst first.
+    [[nodiscard]] std::vector<ConnectionStats> Worst(Order order, size_t limit) const;
+
+    // Parses "rtt", "buffered", "dropped" or "bytes_out".
+    static bool ParseOrder(std::string_view name, Order& order);
+
+    static std::string ToJson(const std::vector<ConnectionStats>& stats);
+
+    // Top-`limit` tables for the periodic report.
+    void Print(std::ostream& out, size_t limit) const;
+
+private:
+    mutable std::mutex mtx_;
+    std::vector<std::vector<ConnectionStats>> workers_;
+};
+
+extern std::shared_ptr<ConnectionStatsBoard> connection_stats;
+
+#endif
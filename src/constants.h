@@ -4,6 +4,14 @@
 namespace constants {
     constexpr int FIXED_VIEW_WIDTH = 1600;
     constexpr int FIXED_VIEW_HEIGHT = 900;
+    constexpr int OBJECT_UPDATE_PERIOD_MS = 30; // Snowball grid moves; client views run every tick
+    constexpr int CLIENT_SORT_PERIOD_MS = 1000; // Re-sort each worker's clients by grid cell
+    constexpr int TRACE_WINDOW_MS = 2000;       // Span trace written on SIGUSR2 (--trace-events)
+    constexpr int TICK_LOG_SECONDS = 3600;      // Ticks kept per game thread in --tick-log files
+    constexpr int CONNECTION_STATS_PERIOD_MS = 1000; // Per-connection stats published and pings sent
+    constexpr int WORST_CLIENTS_REPORTED = 5;   // Per table in the periodic report
+    constexpr int MAX_CLIENTS_LISTED = 1000;    // Cap on GET /clients?limit=
+    constexpr int CPU_PROFILE_MAX_SECONDS = 120; // A CPU profile started with SIGUSR1 stops by itself after this
 }
 
 #endif
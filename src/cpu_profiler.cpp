@@ -0,0 +1,207 @@
+#include "cpu_profiler.h"
+
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <signal.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <unordered_map>
+
+// glibc only exposes the target thread of SIGEV_THREAD_ID under this name
+#ifndef sigev_notify_thread_id
+#define sigev_notify_thread_id _sigev_un._tid
+#endif
+
+thread_local CpuProfiler::ThreadSamples *CpuProfiler::local_ = nullptr;
+
+// Frames of HandleSample and the kernel's signal trampoline
+static constexpr int kHandlerFrames = 2;
+
+static std::atomic<bool> toggle_requested{false};
+
+static void HandleToggleSignal(int) {
+    toggle_requested.store(true, std::memory_order_relaxed);
+}
+
+void CpuProfiler::HandleSample(int) {
+    int saved_errno = errno;
+    ThreadSamples *thread = local_;
+    if (thread && instance().running_.load(std::memory_order_acquire)) {
+        uint64_t head = thread->head.load(std::memory_order_relaxed);
+        if (head < thread->capacity) {
+            void *frames[kMaxFrames + kHandlerFrames];
+            int depth = backtrace(frames, kMaxFrames + kHandlerFrames) - kHandlerFrames;
+            Sample& sample = thread->samples[head];
+            sample.depth = depth > 0 ? static_cast<uint32_t>(depth) : 0;
+            std::memcpy(sample.frames, frames + kHandlerFrames, sample.depth * sizeof(void *));
+            thread->head.store(head + 1, std::memory_order_release);
+        } else {
+            thread->dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    errno = saved_errno;
+}
+
+void CpuProfiler::Enable(int hz, int max_seconds) {
+    if (hz <= 0) return;
+    hz_ = hz;
+    max_seconds_ = max_seconds;
+
+    // The first backtrace() loads libgcc_s, which allocates: not in a handler
+    void *warm_up[1];
+    backtrace(warm_up, 1);
+
+    struct sigaction action = {};
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART;
+    action.sa_handler = HandleSample;
+    sigaction(SIGPROF, &action, nullptr);
+    action.sa_handler = HandleToggleSignal;
+    sigaction(SIGUSR1, &action, nullptr);
+}
+
+void CpuProfiler::RegisterThread(std::string name) {
+    if (!enabled()) return;
+    auto thread = std::make_unique<ThreadSamples>();
+    thread->name = std::move(name);
+
+    struct sigevent event = {};
+    event.sigev_notify = SIGEV_THREAD_ID;
+    event.sigev_signo = SIGPROF;
+    event.sigev_notify_thread_id = gettid();
+    if (timer_create(CLOCK_THREAD_CPUTIME_ID, &event, &thread->timer) != 0) {
+        std::cerr << "Warning: no CPU profiling timer for " << thread->name << ": "
+                  << std::strerror(errno) << std::endl;
+        return;
+    }
+    local_ = thread.get();
+    std::lock_guard<std::mutex> lock(threads_mtx_);
+    threads_.push_back(std::move(thread));
+}
+
+bool CpuProfiler::ArmTimers(long long interval_ns) {
+    struct itimerspec spec = {};
+    spec.it_interval.tv_sec = interval_ns / 1000000000LL;
+    spec.it_interval.tv_nsec = interval_ns % 1000000000LL;
+    spec.it_value = spec.it_interval;
+    bool ok = true;
+    for (auto& thread : threads_) {
+        ok &= timer_settime(thread->timer, 0, &spec, nullptr) == 0;
+    }
+    return ok;
+}
+
+bool CpuProfiler::Start() {
+    std::lock_guard<std::mutex> lock(threads_mtx_);
+    if (!enabled() || running()) return false;
+    // A thread takes at most hz samples per second of CPU, so buffers sized
+    // for max_seconds of wall time cannot fill before Poll() stops them
+    size_t capacity = static_cast<size_t>(hz_) * max_seconds_;
+    for (auto& thread : threads_) {
+        thread->samples = std::make_unique<Sample[]>(capacity);
+        thread->capacity = capacity;
+        thread->head.store(0, std::memory_order_relaxed);
+        thread->dropped.store(0, std::memory_order_relaxed);
+    }
+    started_ = std::chrono::steady_clock::now();
+    running_.store(true, std::memory_order_release);
+    if (!ArmTimers(1000000000LL / hz_)) {
+        ArmTimers(0);
+        running_.store(false, std::memory_order_release);
+        return false;
+    }
+    return true;
+}
+
+bool CpuProfiler::Stop(const std::string& path) {
+    {
+        std::lock_guard<std::mutex> lock(threads_mtx_);
+        if (!running()) return false;
+        ArmTimers(0);
+        // Signals already pending see this and drop their sample
+        running_.store(false, std::memory_order_release);
+    }
+    return WriteFolded(path);
+}
+
+std::string CpuProfiler::Poll() {
+    bool toggle = toggle_requested.exchange(false, std::memory_order_relaxed);
+    if (!enabled()) return "";
+    if (!running()) {
+        if (toggle) Start();
+        return "";
+    }
+    if (!toggle && std::chrono::steady_clock::now() - started_ < std::chrono::seconds(max_seconds_)) return "";
+    std::string path = "cpu-profile-" + std::to_string(time(nullptr)) + ".folded";
+    return Stop(path) ? path : "";
+}
+
+// Function name of a code address, or module+offset for addr2line when the
+// symbol is not exported (link with -rdynamic for the server's own functions)
+static std::string Symbolize(void *pc) {
+    Dl_info info;
+    if (!dladdr(pc, &info) || !info.dli_fname) return "[unknown]";
+    std::string name;
+    if (info.dli_sname) {
+        int status = 0;
+        char *demangled = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+        name = status == 0 ? demangled : info.dli_sname;
+        std::free(demangled);
+    } else {
+        const char *module = std::strrchr(info.dli_fname, '/');
+        char offset[32];
+        std::snprintf(offset, sizeof(offset), "+0x%zx",
+                      static_cast<size_t>(static_cast<char *>(pc) - static_cast<char *>(info.dli_fbase)));
+        name = std::string(module ? module + 1 : info.dli_fname) + offset;
+    }
+    // ';' separates frames in the folded format
+    for (char& c : name) {
+        if (c == ';') c = ':';
+    }
+    return name;
+}
+
+bool CpuProfiler::WriteFolded(const std::string& path) {
+    std::unordered_map<void *, std::string> symbols;
+    std::map<std::string, uint64_t> stacks;
+    uint64_t dropped = 0;
+    {
+        std::lock_guard<std::mutex> lock(threads_mtx_);
+        for (const auto& thread : threads_) {
+            uint64_t count = std::min<uint64_t>(thread->head.load(std::memory_order_acquire), thread->capacity);
+            dropped += thread->dropped.load(std::memory_order_relaxed);
+            for (uint64_t i = 0; i < count; i++) {
+                const Sample& sample = thread->samples[i];
+                std::string stack = thread->name;
+                for (uint32_t f = sample.depth; f-- > 0;) {
+                    // Outer frames hold return addresses: look up the call instead
+                    void *pc = static_cast<char *>(sample.frames[f]) - (f > 0 ? 1 : 0);
+                    auto [it, added] = symbols.try_emplace(pc);
+                    if (added) it->second = Symbolize(pc);
+                    stack += ';';
+                    stack += it->second;
+                }
+                stacks[stack]++;
+            }
+        }
+    }
+
+    std::ofstream out(path);
+    if (!out) return false;
+    for (const auto& [stack, count] : stacks) {
+        out << stack << ' ' << count << '\n';
+    }
+    if (dropped > 0) {
+        std::cerr << "Warning: " << dropped << " CPU profile samples dropped (buffers full)" << std::endl;
+    }
+    return static_cast<bool>(out);
+}
@@ -0,0 +1,84 @@
+#ifndef CPU_PROFILER_H
+#define CPU_PROFILER_H
+
+#include <time.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Sampling CPU profiler for the game, I/O and view-pool threads, written as
+// folded stacks ("Worker 0;main;...;leaf 42"), the input of flamegraph.pl,
+// speedscope and Perfetto.
+//
+// Every registered thread gets a POSIX timer on its own CPU-time clock that
+// sends it SIGPROF, so a thread is sampled in proportion to the CPU it burns
+// and idle workers cost nothing. The timers stay disarmed until a profile is
+// started; when stopped, the only cost left is one timer per thread. The
+// signal handler only unwinds the stack into the thread's preallocated
+// buffer, which stops (counting drops) instead of wrapping when full.
+//
+// kill -USR1 starts a profile and a second one stops it; the report loop
+// does the work in Poll(), outside the signal handlers.
+class CpuProfiler {
+public:
+    static CpuProfiler& instance() {
+        static CpuProfiler inst;
+        return inst;
+    }
+
+    // Sampling rate while running; installs the SIGPROF and SIGUSR1
+    // handlers. Call before the threads register. 0 leaves the profiler off.
+    void Enable(int hz, int max_seconds);
+
+    [[nodiscard]] bool enabled() const { return hz_ > 0; }
+    [[nodiscard]] bool running() const { return running_.load(std::memory_order_relaxed); }
+
+    // Creates the calling thread's timer; `name` is the root frame of its stacks.
+    void RegisterThread(std::string name);
+
+    // Arms every thread's timer, after (re)allocating the sample buffers.
+    bool Start();
+    // Disarms the timers and writes the folded stacks to `path`.
+    bool Stop(const std::string& path);
+
+    // Starts or stops on SIGUSR1, and stops once the buffers hold
+    // max_seconds of samples. Returns the path of a profile it wrote, or an
+    // empty string.
+    std::string Poll();
+
+private:
+    static constexpr int kMaxFrames = 48;
+
+    struct Sample {
+        uint32_t depth;
+        void *frames[kMaxFrames];   // Innermost first
+    };
+    struct ThreadSamples {
+        std::string name;
+        timer_t timer{};
+        std::unique_ptr<Sample[]> samples;
+        size_t capacity = 0;
+        std::atomic<uint64_t> head{0};      // Samples written
+        std::atomic<uint64_t> dropped{0};   // Taken while the buffer was full
+    };
+
+    static thread_local ThreadSamples *local_;   // The calling thread's, for the handler
+
+    static void HandleSample(int);
+    bool ArmTimers(long long interval_ns);
+    bool WriteFolded(const std::string& path);
+
+    int hz_ = 0;
+    int max_seconds_ = 0;
+    std::atomic<bool> running_{false};
+    std::chrono::steady_clock::time_point started_;
+    std::mutex threads_mtx_;
+    std::vector<std::unique_ptr<ThreadSamples>> threads_;
+};
+
+#endif
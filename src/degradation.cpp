@@ -0,0 +1,29 @@
+#include "degradation.h"
+
+void DegradationController::Observe(long long tick_us, long long budget_us) {
+    if (budget_us <= 0) return;
+    load_ += kSmoothing * (static_cast<double>(tick_us) / budget_us - load_);
+    ticks_since_change_++;
+
+    if (load_ > kRaiseAbove && level_ < kMaxLevel && ticks_since_change_ >= kRaiseHoldTicks) {
+        level_++;
+        ticks_since_change_ = 0;
+    } else if (load_ < kLowerBelow && level_ > 0 && ticks_since_change_ >= kLowerHoldTicks) {
+        level_--;
+        ticks_since_change_ = 0;
+    }
+}
+
+bool DegradationController::ShouldSend(long long tick, uint64_t client_id,
+                                       long long last_input_ms, long long current_time) const {
+    bool idle = current_time - last_input_ms > kIdleAfterMs;
+    int every = 1;
+    switch (level_) {
+    case 0: every = 1; break;
+    case 1:
+    case 2: every = 2; break;
+    default: every = idle ? 10 : 3; break;
+    }
+    // Offset by client so the skipped work is spread across ticks
+    return (tick + static_cast<long long>(client_id % every)) % every == 0;
+}
@@ -0,0 +1,49 @@
+#ifndef DEGRADATION_H
+#define DEGRADATION_H
+
+#include <cstdint>
+
+// Overload-driven load shedding for snapshot sends, one per game thread.
+//
+// Observe() is fed every tick's duration. When the smoothed tick time stays
+// above the budget the level steps up, and it steps back down once load has
+// been low for a while (the asymmetric hold times keep it from flapping).
+// Levels are cumulative:
+//   0 normal     every client gets a snapshot every tick
+//   1 half rate  each client gets every 2nd tick (clients staggered)
+//   2 trimmed    every 2nd tick, and the view box shrinks to 70% per axis
+//   3 idle skip  every 3rd tick; clients with no input for a second, every 10th
+class DegradationController {
+public:
+    static constexpr int kMaxLevel = 3;
+
+    // duration/budget of one tick, in microseconds.
+    void Observe(long long tick_us, long long budget_us);
+
+    [[nodiscard]] int level() const { return level_; }
+
+    // Whether this client gets a snapshot this tick. Skipped clients still get
+    // hit detection (CheckPlayerCollisions) and keep their pending events and
+    // interest state, so their next snapshot carries everything in between;
+    // a hit that kills the player sends its snapshot in the same tick.
+    // A client is idle if its last input (player time_update) is over a second old.
+    [[nodiscard]] bool ShouldSend(long long tick, uint64_t client_id,
+                                  long long last_input_ms, long long current_time) const;
+
+    // Fraction of the normal view half-extents to search.
+    [[nodiscard]] double view_scale() const { return level_ >= 2 ? 0.7 : 1.0; }
+
+private:
+    static constexpr double kSmoothing = 0.1;     // EWMA weight of the newest tick
+    static constexpr double kRaiseAbove = 0.85;   // Of the tick budget
+    static constexpr double kLowerBelow = 0.5;
+    static constexpr int kRaiseHoldTicks = 20;    // Minimum ticks between changes
+    static constexpr int kLowerHoldTicks = 200;
+    static constexpr long long kIdleAfterMs = 1000;
+
+    int level_ = 0;
+    double load_ = 0.0;
+    int ticks_since_change_ = 0;
+};
+
+#endif
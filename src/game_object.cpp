@@ -10,9 +10,10 @@ bool GameObject::Expired(long long current_time) {
 }
 
 // Checks for a collision with another GameObject.
-// If a collision occurs, marks the object as dead and returns true.
+// Several threads may test the same object at once, so a hit is claimed
+// atomically and only the winner gets true; the owner then applies Kill().
 bool GameObject::Collide(const std::shared_ptr<GameObject>& obj) {
-    if (get_is_dead())
+    if (get_is_dead() || hit_claimed_.load(std::memory_order_relaxed))
         return false;
 
     auto now = std::chrono::system_clock::now();
@@ -25,97 +26,40 @@ bool GameObject::Collide(const std::shared_ptr<GameObject>& obj) {
     double size_sum = obj->get_size() + get_size();
 
     if (distance_square < (size_sum * size_sum)) {
-        set_is_dead(true);
-        // Update time to start the death grace period
-        set_time_update(current_time);
-        set_life_length(1000); // 1 second grace period for clients to see death
-        return true;
+        return !hit_claimed_.exchange(true, std::memory_order_acq_rel);
     }
     return false;
 }
 
+void GameObject::Kill(long long current_time) {
+    set_is_dead(true);
+    // Update time to start the death grace period
+    set_time_update(current_time);
+    set_life_length(1000); // 1 second grace period for clients to see death
+}
+
 // Applies damage to the object and marks it as dead if health reaches zero.
-void GameObject::Hurt(uWS::WebSocket<true, true, PointerToPlayer>* ws, int damage) {
+// Returns the event to report to the owning client.
+GameEvent GameObject::Hurt(int damage, long long current_time) {
     set_health(std::max(get_health() - damage, 0));
+    GameEvent event{GameEvent::kHit, get_health(), damage, current_time};
     if (get_health() == 0) { 
-        set_is_dead(true);
-        // Update time to start the death grace period
-        auto now = std::chrono::system_clock::now();
-        set_time_update(std::chrono::duration_cast<std::chrono::milliseconds>(
-            now.time_since_epoch()).count());
-        set_life_length(1000); // 1 second grace period for clients to see death
+        Kill(current_time);
+        event.type = GameEvent::kDeath;
     }
-    SendMessageToClient(ws, "hit");
+    return event;
 }
 
-// Builds a JSON object with the game object's current state
-json GameObject::ToJson(long long current_time, std::string messageType) {
-    return {
-        {"id", get_id()},
-        {"messageType", messageType},
-        {"objectType", get_type()},
-        {"username", get_username()},
-        {"position", {{"x", get_cur_x(current_time)}, {"y", get_cur_y(current_time)}}},
-        {"velocity", {{"x", get_vx()}, {"y", get_vy()}}},
-        {"size", get_size()},
-        {"charging", get_charging()},
-        {"expireDate", current_time + get_life_length()},
-        {"isDead", get_is_dead()},
-        {"timeUpdate", get_time_update()},
-        {"newHealth", get_health()}
-    };
-}
-
-// Builds a MessagePack binary representation of the game object's current state
-void GameObject::ToMsgPack(msgpack::packer<msgpack::sbuffer>& pk, long long current_time) const {
-    // Pack as map with 11 fields
-    pk.pack_map(11);
-    
-    pk.pack("id");
-    pk.pack(get_id());
-    
-    pk.pack("objectType");
-    pk.pack(get_type());
-    
-    pk.pack("username");
-    pk.pack(get_username());
-    
-    pk.pack("position");
-    pk.pack_map(2);
-    pk.pack("x"); pk.pack(get_cur_x(current_time));
-    pk.pack("y"); pk.pack(get_cur_y(current_time));
-    
-    pk.pack("velocity");
-    pk.pack_map(2);
-    pk.pack("x"); pk.pack(get_vx());
-    pk.pack("y"); pk.pack(get_vy());
-    
-    pk.pack("size");
-    pk.pack(get_size());
-    
-    pk.pack("charging");
-    pk.pack(get_charging());
-    
-    pk.pack("expireDate");
-    pk.pack(current_time + get_life_length());
-    
-    pk.pack("isDead");
-    pk.pack(get_is_dead());
-    
-    pk.pack("timeUpdate");
-    pk.pack(get_time_update());
-    
-    pk.pack("newHealth");
-    pk.pack(get_health());
+// Packs the fields that rarely change; sent once when the object enters view
+void GameObject::PackSpawn(msgpack::packer<msgpack::sbuffer>& pk, uint16_t slot) const {
+    SpawnEntry entry{slot, get_id(), get_type(), get_username(), get_size()};
+    schema::PackArray(pk, entry);
 }
 
-// Sends a message to the client with the object's current state.
-void GameObject::SendMessageToClient(uWS::WebSocket<true, true, PointerToPlayer>* ws, std::string type) {
-    PROFILE_FUNCTION();
-    
-    auto now = std::chrono::system_clock::now();
-    long long current_time = std::chrono::duration_cast<std::chrono::milliseconds>(
-        now.time_since_epoch()).count();
-    
-    ws->send(ToJson(current_time, type).dump(), uWS::OpCode::TEXT);
+// Packs the per-tick state, keyed by the client's slot instead of the string id
+void GameObject::PackUpdate(msgpack::packer<msgpack::sbuffer>& pk, uint16_t slot, long long current_time) const {
+    UpdateEntry entry{slot, get_cur_x(current_time), get_cur_y(current_time), get_vx(), get_vy(),
+                      get_charging(), current_time + get_life_length(), get_is_dead(),
+                      get_time_update(), get_health()};
+    schema::PackArray(pk, entry);
 }
@@ -4,17 +4,55 @@
 #include <string>
 #include <memory>
 #include <chrono>
-#include <uWebSockets/App.h>
+#include <vector>
+#include <cstdint>
+#include <atomic>
 
-#include "nlohmann/json.hpp"
 #include "msgpack.hpp"
-
-using json = nlohmann::json;
+#include "interest_set.h"
+#include "message_schema.h"
 
 class Player;
 
+// A field its owning thread writes while other threads read it (views and hit
+// checks run on every worker). Relaxed atomics compile to plain loads and
+// stores but make those reads well defined; a reader may see some fields from
+// before an update and some from after, which the next tick corrects.
+template <typename T>
+class Relaxed {
+public:
+    Relaxed(T value = T{}) : value_(value) {}
+    operator T() const { return value_.load(std::memory_order_relaxed); }
+    Relaxed& operator=(T value) {
+        value_.store(value, std::memory_order_relaxed);
+        return *this;
+    }
+    T operator++(int) {  // Owner only
+        T old = *this;
+        *this = old + 1;
+        return old;
+    }
+
+private:
+    std::atomic<T> value_;
+};
+
 struct PointerToPlayer {
     std::shared_ptr<Player> player;
+    InterestSet interest; // Objects this client has been told about
+    bool packed_snapshots = false; // Use snapshot_codec instead of msgpack
+    std::vector<GameEvent> pending_events; // Flushed with the next batch_update
+    uint64_t client_id = 0; // Unique per connection; keys the simulation thread's state in simulation mode
+    bool backpressured = false; // Socket over --backpressure-limit; snapshots wait until it drains
+    uint64_t dropped_snapshots = 0; // Snapshots skipped (coalesced) while backpressured
+    uint32_t registry_slot = UINT32_MAX; // Index in the worker's ClientRegistry, if registered
+    // Traffic on the socket, counted on its loop thread (see ConnectionStatsBoard)
+    uint64_t bytes_in = 0, messages_in = 0;
+    uint64_t bytes_out = 0, messages_out = 0;
+    long long rtt_us = -1; // Last WebSocket ping round trip
+    std::chrono::steady_clock::time_point ping_sent{}; // Unanswered ping, or the epoch
+    std::chrono::steady_clock::time_point connected_at{};
+    bool joined = false; // player has been inserted into the grid
 };
 
 class GameObject {
@@ -25,14 +63,14 @@ public:
           x_(0), y_(0), vx_(0), vy_(0), size_(1),
           row_(0), col_(0), health_(100), damage_(0),
           time_update_(0), life_length_(1000),
-          is_dead_(false) {}
+          is_dead_(false), static_version_(0) {}
 
     GameObject(std::string id, std::string type)
         : type_(std::move(type)), id_(std::move(id)), username_("unknown"),
           x_(0), y_(0), vx_(0), vy_(0), size_(1),
           row_(0), col_(0), health_(100), damage_(0),
           time_update_(0), life_length_(1000),
-          is_dead_(false) {}
+          is_dead_(false), static_version_(0) {}
 
     virtual ~GameObject() = default;
 
@@ -52,20 +90,27 @@ public:
     long long get_time_update() const { return time_update_; }
     long long get_life_length() const { return life_length_; }
     bool get_is_dead() const { return is_dead_; }
+    uint32_t get_static_version() const { return static_version_; }
+    // Worker whose thread created the object and alone may change it; -1 when
+    // one thread owns everything (simulation mode)
+    int get_owner() const { return owner_; }
 
     // Virtual functions for current position calculations
     virtual double get_cur_x(long long /*current_time*/) const { return x_; }
     virtual double get_cur_y(long long /*current_time*/) const { return y_; }
 
-    // Setters - pass strings by value and move (copy elision optimization)
-    void set_type(std::string type) { type_ = std::move(type); }
-    void set_id(std::string id) { id_ = std::move(id); }
-    void set_username(std::string username) { username_ = std::move(username); }
+    // Setters - pass strings by value and move (copy elision optimization).
+    // Static fields bump static_version_ on change so clients get a fresh spawn.
+    // The strings are plain: set them only before the object is shared (in
+    // the grid), since other threads read them without synchronization.
+    void set_type(std::string type) { if (type != type_) { type_ = std::move(type); static_version_++; } }
+    void set_id(std::string id) { if (id != id_) { id_ = std::move(id); static_version_++; } }
+    void set_username(std::string username) { if (username != username_) { username_ = std::move(username); static_version_++; } }
     void set_x(double x) { x_ = x; }
     void set_y(double y) { y_ = y; }
     void set_vx(double vx) { vx_ = vx; }
     void set_vy(double vy) { vy_ = vy; }
-    void set_size(double size) { size_ = size; }
+    void set_size(double size) { if (size != size_) { size_ = size; static_version_++; } }
     void set_row(int row) { row_ = row; }
     void set_col(int col) { col_ = col; }
     void set_health(int health) { health_ = health; }
@@ -73,24 +118,31 @@ public:
     void set_time_update(long long time_update) { time_update_ = time_update; }
     void set_life_length(long long life_length) { life_length_ = life_length; }
     void set_is_dead(bool is_dead) { is_dead_ = is_dead; }
+    void set_owner(int owner) { owner_ = owner; }  // Before the object is shared
 
     // Default implementation of get_charging; can be overridden by derived classes.
     virtual bool get_charging() const { return false; }
 
     // Other member functions (pass shared_ptr by const reference to avoid refcount overhead)
     [[nodiscard]] bool Expired(long long current_time);
+    // Any thread; true for only the first caller to land a hit with this object.
     [[nodiscard]] bool Collide(const std::shared_ptr<GameObject>& obj);
-    void Hurt(uWS::WebSocket<true, true, PointerToPlayer>* ws, int damage);
-    [[nodiscard]] json ToJson(long long current_time, std::string messageType = "movement");
-    void ToMsgPack(msgpack::packer<msgpack::sbuffer>& pk, long long current_time) const;
-    virtual void SendMessageToClient(uWS::WebSocket<true, true, PointerToPlayer>* ws, std::string type);
+    // Owner only: dead, kept for a short grace period so clients see it die.
+    void Kill(long long current_time);
+    [[nodiscard]] GameEvent Hurt(int damage, long long current_time);
+    // Packed as SpawnEntry / UpdateEntry arrays (see message_schema.h)
+    void PackSpawn(msgpack::packer<msgpack::sbuffer>& pk, uint16_t slot) const;
+    void PackUpdate(msgpack::packer<msgpack::sbuffer>& pk, uint16_t slot, long long current_time) const;
 
 protected:
     std::string type_, id_, username_;
-    double x_, y_, vx_, vy_, size_;
-    int row_, col_, health_, damage_;
-    long long time_update_, life_length_;
-    bool is_dead_;
+    Relaxed<double> x_, y_, vx_, vy_, size_;
+    Relaxed<int> row_, col_, health_, damage_;
+    Relaxed<long long> time_update_, life_length_;
+    Relaxed<bool> is_dead_;
+    Relaxed<uint32_t> static_version_;
+    int owner_ = -1;
+    std::atomic<bool> hit_claimed_{false};
 };
 
 class Player : public GameObject {
@@ -118,7 +170,7 @@ public:
     void set_charging(bool charging) { charging_ = charging; }
 
 private:
-    bool charging_;
+    Relaxed<bool> charging_;
 };
 
 #endif // GAME_OBJECT_H
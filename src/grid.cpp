@@ -1,6 +1,10 @@
 #include "grid.h"
 #include "profiler.h"
 
+#include <algorithm>
+#include <iomanip>
+#include <ostream>
+
 
 Grid::Grid(int height, int width, int cell_size)
     : height_(height), width_(width), cell_size_(cell_size),
@@ -85,13 +89,84 @@ std::vector<std::shared_ptr<GameObject>> Grid::Search(double lower_y, double upp
         for (int c = left_col; c <= right_col; c++) {
             if (r >= rows_ || c >= cols_ || r < 0 || c < 0) continue;  // Boundary check
             
-            // Measure lock acquisition time
-            LockTimer timer("Grid::Search_CellLock");
-            std::shared_lock<std::shared_mutex> lock(*(cells_[r][c]->mtx));
-            auto& cell_objs = cells_[r][c]->objects;
+            Cell& cell = *cells_[r][c];
+            TimedLock<std::shared_lock<std::shared_mutex>> lock(*cell.mtx, cell.lock_stats,
+                                                                LOCK_SITE("Grid::Search_CellLock"));
+            auto& cell_objs = cell.objects;
             all.insert(all.end(), cell_objs.begin(), cell_objs.end());
         }
     }
 
     return all;
 }
+
+void Grid::PrintLockHeatmap(std::ostream& out) {
+    // One character per block of cells, so large worlds fit on a terminal
+    constexpr int kMaxMapSide = 64;
+    constexpr char kRamp[] = " .:-=+*#%@";
+    constexpr int kShades = sizeof(kRamp) - 2;
+    constexpr size_t kHottestCells = 5;
+
+    struct HotCell {
+        int row, col;
+        LockStats::Totals totals;
+    };
+    std::vector<HotCell> cells;
+    cells.reserve(static_cast<size_t>(rows_) * cols_);
+    uint64_t acquisitions = 0;
+    for (int r = 0; r < rows_; r++) {
+        for (int c = 0; c < cols_; c++) {
+            cells.push_back({r, c, cells_[r][c]->lock_stats.Take()});
+            acquisitions += cells.back().totals.acquisitions;
+        }
+    }
+    if (acquisitions == 0) return;
+
+    int block_rows = (rows_ - 1) / kMaxMapSide + 1;
+    int block_cols = (cols_ - 1) / kMaxMapSide + 1;
+    int map_rows = (rows_ - 1) / block_rows + 1;
+    int map_cols = (cols_ - 1) / block_cols + 1;
+    std::vector<uint64_t> wait(static_cast<size_t>(map_rows) * map_cols, 0);
+    for (const auto& cell : cells) {
+        wait[(cell.row / block_rows) * map_cols + cell.col / block_cols] += cell.totals.wait_ns;
+    }
+    uint64_t max_wait = *std::max_element(wait.begin(), wait.end());
+
+    out << "\n=== LOCK CONTENTION HEATMAP ===\n";
+    if (max_wait == 0) {
+        out << "No waits on " << acquisitions << " cell lock acquisitions\n"
+            << "===============================\n";
+        return;
+    }
+    out << "Wait for cell locks; row 0 at the top, " << block_rows << "x" << block_cols
+        << " cells per character, '" << kRamp[kShades] << "' = " << std::fixed << std::setprecision(3)
+        << max_wait / 1e6 << " ms\n";
+    out << "+" << std::string(map_cols, '-') << "+\n";
+    for (int r = 0; r < map_rows; r++) {
+        out << "|";
+        for (int c = 0; c < map_cols; c++) {
+            uint64_t w = wait[r * map_cols + c];
+            // Any wait at all shows, however small next to the maximum
+            int shade = w == 0 ? 0 : std::max<int>(1, static_cast<int>(w * kShades / max_wait));
+            out << kRamp[shade];
+        }
+        out << "|\n";
+    }
+    out << "+" << std::string(map_cols, '-') << "+\n";
+
+    size_t hottest = std::min(kHottestCells, cells.size());
+    std::partial_sort(cells.begin(), cells.begin() + hottest, cells.end(),
+                      [](const HotCell& a, const HotCell& b) { return a.totals.wait_ns > b.totals.wait_ns; });
+    out << std::left << std::setw(14) << "Cell (r,c)" << std::right << std::setw(12) << "Wait (ms)"
+        << std::setw(14) << "Max Wait (us)" << std::setw(12) << "Hold (ms)" << std::setw(13) << "Contended %"
+        << std::setw(14) << "Acquisitions" << "\n";
+    for (size_t i = 0; i < hottest && cells[i].totals.wait_ns > 0; i++) {
+        const auto& t = cells[i].totals;
+        std::string where = "(" + std::to_string(cells[i].row) + "," + std::to_string(cells[i].col) + ")";
+        out << std::left << std::setw(14) << where << std::right << std::fixed << std::setprecision(3)
+            << std::setw(12) << t.wait_ns / 1e6 << std::setw(14) << std::setprecision(1) << t.max_wait_ns / 1e3
+            << std::setw(12) << std::setprecision(3) << t.hold_ns / 1e6 << std::setw(13) << std::setprecision(1)
+            << 100.0 * t.contended / t.acquisitions << std::setw(14) << t.acquisitions << "\n";
+    }
+    out << "===============================\n";
+}
@@ -5,26 +5,27 @@
 #include <memory>
 #include <vector>
 #include <shared_mutex>
+#include <iosfwd>
 
 #include "game_object.h"
 #include "profiler.h"
+#include "lock_stats.h"
 
 struct Cell {
     std::unordered_set<std::shared_ptr<GameObject>> objects;
     std::unique_ptr<std::shared_mutex> mtx;
+    LockStats lock_stats; // Contention on mtx, for the heatmap
 
     // Constructor to initialize the mutex pointer.
     Cell() : mtx(std::make_unique<std::shared_mutex>()) {}
 
     void Insert(const std::shared_ptr<GameObject>& obj) {
-        LockTimer timer("Cell::Insert");
-        std::unique_lock<std::shared_mutex> lock(*mtx);
+        TimedLock<std::unique_lock<std::shared_mutex>> lock(*mtx, lock_stats, LOCK_SITE("Cell::Insert"));
         objects.insert(obj);
     }
 
     void Remove(const std::shared_ptr<GameObject>& obj) {
-        LockTimer timer("Cell::Remove");
-        std::unique_lock<std::shared_mutex> lock(*mtx);
+        TimedLock<std::unique_lock<std::shared_mutex>> lock(*mtx, lock_stats, LOCK_SITE("Cell::Remove"));
         objects.erase(obj);
     }
 };
@@ -51,6 +52,11 @@ public:
     void Update(const std::shared_ptr<GameObject>& obj, long long current_time);
 
     [[nodiscard]] std::vector<std::shared_ptr<GameObject>> Search(double lower_y, double upper_y, double left_x, double right_x);
+
+    // Renders time spent waiting for each cell's lock since the previous
+    // call as an ASCII map of the world, plus the hottest cells. Needs
+    // PROFILE_LEVEL_TIMING; prints nothing if no lock was taken.
+    void PrintLockHeatmap(std::ostream& out);
 };
 
 #endif
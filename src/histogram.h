@@ -0,0 +1,79 @@
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include <array>
+#include <bit>
+#include <cstdint>
+
+// Log-linear latency histogram in the style of HdrHistogram.
+//
+// Values below 32 get a bucket each; above that every power of two is split
+// into 16 equal buckets, so any recorded value is known to within 1/16
+// (6.25%) of itself. Values are non-negative integers (microseconds in the
+// profiler); anything past 2^40 lands in the last bucket. Histograms with the
+// same layout merge by adding counts, which is how per-thread samples are
+// combined for a report.
+class LatencyHistogram {
+public:
+    static constexpr int kSubBucketBits = 4;
+    static constexpr int kSubBuckets = 1 << kSubBucketBits;
+    static constexpr int kMaxExponent = 40;
+    static constexpr int kBuckets = (kMaxExponent - kSubBucketBits + 2) * kSubBuckets;
+
+    static constexpr int BucketOf(long long value) {
+        if (value < 2 * kSubBuckets) return value < 0 ? 0 : static_cast<int>(value);
+        int exponent = std::bit_width(static_cast<uint64_t>(value)) - 1;
+        if (exponent > kMaxExponent) return kBuckets - 1;
+        int shift = exponent - kSubBucketBits;
+        return (shift + 1) * kSubBuckets + static_cast<int>(value >> shift) - kSubBuckets;
+    }
+
+    // Largest value that falls into `bucket`.
+    static constexpr long long BucketUpper(int bucket) {
+        if (bucket < 2 * kSubBuckets) return bucket;
+        int shift = bucket / kSubBuckets - 1;
+        long long lower = static_cast<long long>(kSubBuckets + bucket % kSubBuckets) << shift;
+        return lower + (1LL << shift) - 1;
+    }
+
+    void add(long long value) { add_bucket(BucketOf(value), 1); }
+
+    void add_bucket(int bucket, uint64_t count) {
+        counts_[bucket] += count;
+        total_ += count;
+    }
+
+    void merge(const LatencyHistogram& other) {
+        for (int i = 0; i < kBuckets; i++) counts_[i] += other.counts_[i];
+        total_ += other.total_;
+    }
+
+    void clear() {
+        counts_.fill(0);
+        total_ = 0;
+    }
+
+    [[nodiscard]] uint64_t count() const { return total_; }
+    [[nodiscard]] uint64_t count_at(int bucket) const { return counts_[bucket]; }
+
+    // Smallest bucket bound that at least `percent` of the samples are at or
+    // below (50 = median, 99.9 = one in a thousand is slower). 0 if empty.
+    [[nodiscard]] long long percentile(double percent) const {
+        if (total_ == 0) return 0;
+        uint64_t rank = static_cast<uint64_t>(percent / 100.0 * static_cast<double>(total_) + 0.5);
+        if (rank < 1) rank = 1;
+        if (rank > total_) rank = total_;
+        uint64_t seen = 0;
+        for (int i = 0; i < kBuckets; i++) {
+            seen += counts_[i];
+            if (seen >= rank) return BucketUpper(i);
+        }
+        return BucketUpper(kBuckets - 1);
+    }
+
+private:
+    std::array<uint64_t, kBuckets> counts_{};
+    uint64_t total_ = 0;
+};
+
+#endif
@@ -0,0 +1,157 @@
+#include "interest_set.h"
+#include "game_object.h"
+#include "profiler.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    constexpr uint32_t kMaxSlots = 0xFFFF;
+
+    constexpr double kNearRadius = 300.0;      // px; full rate inside
+    constexpr double kFastSpeed = 250.0;       // px/s; full rate at or above
+    constexpr double kMinWeight = 1.0 / 8;     // Farthest objects: every 8th tick
+    constexpr size_t kDespawnBytes = 3;
+
+    // Priority gained per tick: 1 near the viewer, falling off with the
+    // square of distance (i.e. with view area) beyond kNearRadius.
+    float Weight(const GameObject& obj, const InterestSet::UpdateBudget& budget) {
+        if (obj.get_is_dead()) return 1.0f;
+        double speed_sq = obj.get_vx() * obj.get_vx() + obj.get_vy() * obj.get_vy();
+        if (speed_sq >= kFastSpeed * kFastSpeed) return 1.0f;
+        double dx = obj.get_cur_x(budget.current_time) - budget.viewer_x;
+        double dy = obj.get_cur_y(budget.current_time) - budget.viewer_y;
+        double dist_sq = dx * dx + dy * dy;
+        if (dist_sq <= kNearRadius * kNearRadius) return 1.0f;
+        return static_cast<float>(std::max(kMinWeight, kNearRadius * kNearRadius / dist_sq));
+    }
+}
+
+uint16_t InterestSet::AllocateSlot() {
+    if (!free_slots_.empty()) {
+        uint16_t slot = free_slots_.back();
+        free_slots_.pop_back();
+        return slot;
+    }
+    if (next_slot_ >= kMaxSlots) return kMaxSlots;
+    return static_cast<uint16_t>(next_slot_++);
+}
+
+void InterestSet::Update(const std::vector<std::shared_ptr<GameObject>>& visible,
+                         const UpdateBudget* budget) {
+    PROFILE_FUNCTION();
+    tick_++;
+    spawns_.clear();
+    updates_.clear();
+    despawns_.clear();
+    due_.resize(visible.size());  // Room for every object; trimmed to due_count below
+    size_t due_count = 0;
+
+    // Match visible objects against what the client already knows about
+    for (const auto& obj : visible) {
+        auto [it, inserted] = entries_.try_emplace(obj.get());
+        Entry& entry = it->second;
+        if (inserted) {
+            entry.slot = AllocateSlot();
+            if (entry.slot == kMaxSlots) {
+                entries_.erase(it);
+                continue;
+            }
+            entry.obj = obj;
+            entry.static_version = obj->get_static_version();
+            entry.due_tick = tick_ + 1;
+            entry.weight = 1.0f;
+            spawns_.push_back(&entry);
+        } else if (entry.static_version != obj->get_static_version()) {
+            // Static fields changed: re-send them under the same slot
+            entry.static_version = obj->get_static_version();
+            entry.due_tick = tick_ + 1;
+            entry.weight = 1.0f;
+            spawns_.push_back(&entry);
+        } else if (budget) {
+            // Known object: due once the weight taken at its last update has
+            // added up to 1. Appended without a branch: which objects are due
+            // changes every tick, so the predictor cannot learn it
+            bool due = static_cast<int32_t>(tick_ - entry.due_tick) >= 0 || obj->get_is_dead();
+            due_[due_count] = &entry;
+            due_count += due;
+            entry.seen_tick = tick_;
+            continue;
+        }
+        entry.seen_tick = tick_;
+        updates_.push_back(&entry);  // Spawned objects always carry their first update
+    }
+
+    // Anything not seen this tick has left the view
+    for (auto it = entries_.begin(); it != entries_.end();) {
+        if (it->second.seen_tick != tick_) {
+            despawns_.push_back(it->second.slot);
+            free_slots_.push_back(it->second.slot);
+            it = entries_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    due_.resize(due_count);
+    if (!budget) return;
+
+    // Fit the due updates into what's left of the byte budget, most overdue first
+    size_t limit = due_.size();
+    if (budget->max_bytes > 0 && budget->update_bytes > 0) {
+        size_t used = spawns_.size() * budget->spawn_bytes + despawns_.size() * kDespawnBytes +
+                      updates_.size() * budget->update_bytes;
+        limit = used >= budget->max_bytes ? 0 : (budget->max_bytes - used) / budget->update_bytes;
+    }
+    if (limit < due_.size()) {
+        // What the accumulator would hold: 1 when due, plus the weight for
+        // every tick it has waited since
+        for (Entry* entry : due_) {
+            int32_t overdue = static_cast<int32_t>(tick_ - entry->due_tick);
+            entry->priority = 1.0f + static_cast<float>(std::max(overdue, 0)) * entry->weight;
+        }
+        std::nth_element(due_.begin(), due_.begin() + limit, due_.end(),
+                         [](const Entry* a, const Entry* b) { return a->priority > b->priority; });
+        due_.resize(limit);
+    }
+    for (Entry* entry : due_) {
+        // Only objects being sent are weighed
+        entry->weight = Weight(*entry->obj, *budget);
+        entry->due_tick = tick_ + static_cast<uint32_t>(std::ceil(1.0f / entry->weight));
+        updates_.push_back(entry);
+    }
+}
+
+void InterestSet::PackDelta(msgpack::packer<msgpack::sbuffer>& pk,
+                            const std::vector<std::shared_ptr<GameObject>>& visible,
+                            long long current_time, const UpdateBudget* budget) {
+    Update(visible, budget);
+
+    schema::PackKey(pk, BatchUpdate::Key(BatchUpdate::Field::spawns));
+    pk.pack_array(spawns_.size());
+    for (const Entry* entry : spawns_) {
+        entry->obj->PackSpawn(pk, entry->slot);
+    }
+
+    schema::PackKey(pk, BatchUpdate::Key(BatchUpdate::Field::updates));
+    pk.pack_array(updates_.size());
+    for (const Entry* entry : updates_) {
+        entry->obj->PackUpdate(pk, entry->slot, current_time);
+    }
+
+    schema::PackKey(pk, BatchUpdate::Key(BatchUpdate::Field::despawns));
+    pk.pack_array(despawns_.size());
+    for (uint16_t slot : despawns_) {
+        pk.pack(slot);
+    }
+}
+
+void InterestSet::Clear() {
+    entries_.clear();
+    spawns_.clear();
+    updates_.clear();
+    despawns_.clear();
+    due_.clear();
+    free_slots_.clear();
+    next_slot_ = 0;
+}
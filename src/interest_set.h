@@ -0,0 +1,83 @@
+#ifndef INTEREST_SET_H
+#define INTEREST_SET_H
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "msgpack.hpp"
+
+class GameObject;
+
+// Per-client record of the objects the client currently knows about.
+//
+// Each tracked object gets a short numeric slot. Static fields (id, objectType,
+// username, size) are sent once in a "spawn" entry when the object enters view
+// (or when one of them changes), every visible object then gets a compact
+// dynamic update keyed by slot, and a "despawn" entry frees the slot once the
+// object leaves view.
+//
+// With an UpdateBudget, dynamic updates are rationed by a per-object priority
+// accumulator: an object gains weight 1 per tick if it is near the viewer or
+// fast, and less the farther away it is (falling off with area, down to 1/8);
+// once the total reaches 1 it is due. The weight is taken when an update is
+// sent, which fixes the tick the next one is due, so objects in between cost
+// one comparison; a dead object is due at once. Due objects are sent most
+// overdue first until the frame's byte budget runs out, and the rest stay
+// due, so nothing starves. Spawns and despawns are never deferred.
+class InterestSet {
+public:
+    struct Entry {
+        std::shared_ptr<GameObject> obj; // Keeps the address stable while tracked
+        uint16_t slot;
+        uint32_t static_version;
+        uint32_t seen_tick;
+        uint32_t due_tick;          // Budgeted: next update due on this tick
+        float weight;               // Budgeted: priority gained per tick when last sent
+        float priority;             // Budgeted: scratch for ranking due updates
+    };
+
+    struct UpdateBudget {
+        double viewer_x = 0, viewer_y = 0;
+        long long current_time = 0;
+        size_t max_bytes = 0;       // Frame budget; 0 = rate-limit by priority only
+        size_t spawn_bytes = 0;     // Approximate encoded sizes for the codec in use
+        size_t update_bytes = 0;
+    };
+
+    // Encoded sizes of one entry, measured with benchmark/codec_bench
+    static constexpr size_t kMsgPackSpawnBytes = 60;
+    static constexpr size_t kMsgPackUpdateBytes = 60;
+
+    // Diffs the currently visible objects against the tracked state and
+    // advances it; the result is available through spawns/updates/despawns.
+    // Without a budget every visible object gets an update.
+    void Update(const std::vector<std::shared_ptr<GameObject>>& visible,
+                const UpdateBudget* budget = nullptr);
+
+    // Update() followed by packing {spawns, updates, despawns} as three map
+    // entries (key + value each).
+    void PackDelta(msgpack::packer<msgpack::sbuffer>& pk,
+                   const std::vector<std::shared_ptr<GameObject>>& visible,
+                   long long current_time, const UpdateBudget* budget = nullptr);
+
+    void Clear();
+
+    [[nodiscard]] size_t size() const { return entries_.size(); }
+    [[nodiscard]] const std::vector<Entry*>& spawns() const { return spawns_; }
+    [[nodiscard]] const std::vector<Entry*>& updates() const { return updates_; }
+    [[nodiscard]] const std::vector<uint16_t>& despawns() const { return despawns_; }
+
+private:
+    uint16_t AllocateSlot();
+
+    std::unordered_map<const GameObject*, Entry> entries_;
+    std::vector<uint16_t> free_slots_;
+    std::vector<Entry*> spawns_, updates_, due_;
+    std::vector<uint16_t> despawns_;
+    uint32_t next_slot_ = 0;
+    uint32_t tick_ = 0;
+};
+
+#endif
@@ -0,0 +1,116 @@
+#ifndef LOCK_STATS_H
+#define LOCK_STATS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+
+#include "profiler.h"
+
+// Contention counters of one lock (a grid cell's mutex), updated by every
+// thread that takes it. They sit next to the mutex, whose cache line those
+// threads are bouncing anyway.
+struct LockStats {
+    std::atomic<uint64_t> acquisitions{0};
+    std::atomic<uint64_t> contended{0};    // Had to wait: try_lock failed
+    std::atomic<uint64_t> wait_ns{0};
+    std::atomic<uint64_t> hold_ns{0};
+    std::atomic<uint64_t> max_wait_ns{0};
+
+    struct Totals {
+        uint64_t acquisitions = 0, contended = 0, wait_ns = 0, hold_ns = 0, max_wait_ns = 0;
+    };
+
+    void Record(uint64_t wait, uint64_t hold, bool was_contended) {
+        acquisitions.fetch_add(1, std::memory_order_relaxed);
+        hold_ns.fetch_add(hold, std::memory_order_relaxed);
+        if (!was_contended) return;
+        contended.fetch_add(1, std::memory_order_relaxed);
+        wait_ns.fetch_add(wait, std::memory_order_relaxed);
+        uint64_t max = max_wait_ns.load(std::memory_order_relaxed);
+        while (wait > max && !max_wait_ns.compare_exchange_weak(max, wait, std::memory_order_relaxed)) {
+        }
+    }
+
+    // Returns the counts since the previous call and starts over.
+    Totals Take() {
+        return {acquisitions.exchange(0, std::memory_order_relaxed),
+                contended.exchange(0, std::memory_order_relaxed),
+                wait_ns.exchange(0, std::memory_order_relaxed),
+                hold_ns.exchange(0, std::memory_order_relaxed),
+                max_wait_ns.exchange(0, std::memory_order_relaxed)};
+    }
+};
+
+// Profiler ids of a lock site: "LOCK_WAIT:<name>" and "LOCK_HOLD:<name>".
+struct LockSite {
+    Profiler::ScopeId wait = 0;
+    Profiler::ScopeId hold = 0;
+};
+
+#if PROFILE_LEVEL >= PROFILE_LEVEL_TIMING
+#define LOCK_SITE(name) LockSite{PROFILE_ID("LOCK_WAIT:" name), PROFILE_ID("LOCK_HOLD:" name)}
+#else
+#define LOCK_SITE(name) LockSite{}
+#endif
+
+// RAII lock (Lock is std::unique_lock or std::shared_lock) that times the
+// wait to acquire and the time held separately, into the lock's LockStats
+// and the profiler. The uncontended path is a try_lock and two clock reads,
+// as many as the old whole-scope timer took. Below PROFILE_LEVEL_TIMING it
+// is just the lock.
+template <typename Lock>
+class TimedLock {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    TimedLock(typename Lock::mutex_type& mtx, LockStats& stats, LockSite site)
+        : lock_(mtx, std::defer_lock), stats_(stats), site_(site) {
+        if constexpr (!kTimed) {
+            lock_.lock();
+            return;
+        }
+        if (lock_.try_lock()) {
+            acquired_ = Clock::now();
+            return;
+        }
+        requested_ = Clock::now();
+        lock_.lock();
+        acquired_ = Clock::now();
+        contended_ = true;
+    }
+
+    ~TimedLock() {
+        if constexpr (!kTimed) return;
+        auto released = Clock::now();
+        lock_.unlock();
+        uint64_t wait_ns = contended_ ? static_cast<uint64_t>((acquired_ - requested_).count()) : 0;
+        uint64_t hold_ns = static_cast<uint64_t>((released - acquired_).count());
+        stats_.Record(wait_ns, hold_ns, contended_);
+
+        Profiler::instance().record(site_.wait, static_cast<long long>(wait_ns / 1000));
+        Profiler::instance().record(site_.hold, static_cast<long long>(hold_ns / 1000));
+        thread_counters().lock_wait_ns += wait_ns;
+        if constexpr (kProfileLevel >= PROFILE_LEVEL_TRACING) {
+            if (Tracer::instance().enabled()) {
+                if (contended_) Tracer::instance().record(site_.wait, requested_, acquired_);
+                Tracer::instance().record(site_.hold, acquired_, released);
+            }
+        }
+    }
+
+    TimedLock(const TimedLock&) = delete;
+    TimedLock& operator=(const TimedLock&) = delete;
+
+private:
+    static constexpr bool kTimed = kProfileLevel >= PROFILE_LEVEL_TIMING;
+
+    Lock lock_;
+    LockStats& stats_;
+    LockSite site_;
+    Clock::time_point requested_{}, acquired_{};
+    bool contended_ = false;
+};
+
+#endif
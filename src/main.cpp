@@ -1,57 +1,144 @@
+#include <unistd.h>
+
 #include <iostream>
 #include <vector>
 #include <memory>
 
+#include "config.h"
 #include "server_worker.h"
+#include "simulation.h"
 #include "profiler.h"
+#include "metrics.h"
+#include "trace.h"
+#include "cpu_profiler.h"
+#include "constants.h"
+#include "thread_affinity.h"
+#include "connection_balancer.h"
+#include "task_pool.h"
+#include "worker_mailbox.h"
+#include "connection_stats.h"
+#include "admin_server.h"
 
 std::shared_mutex output_mtx;
 std::shared_ptr<Grid> grid;
+ServerConfig server_config;
+std::shared_ptr<ConnectionBalancer> balancer;
+std::shared_ptr<TaskPool> view_pool;
+std::shared_ptr<WorkerMailboxes> mailboxes;
+std::shared_ptr<ConnectionStatsBoard> connection_stats;
 
-thread_local std::unordered_set<uWS::WebSocket<true, true, PointerToPlayer>*> thread_clients;
+thread_local ClientRegistry<ClientSocket> thread_clients;
 thread_local std::unordered_map<std::string, std::shared_ptr<GameObject>> thread_objects;
 
 int main(int argc, char *argv[]) {
-    int workers_num = 4;
     int grid_height = 1600, grid_width = 1600, grid_cell_size = 100;
-    int port = 12345;  // default port
-
-    // Parse command line arguments for port
-    if (argc > 1) {
-        try {
-            port = std::stoi(argv[1]);
-            if (port < 1 || port > 65535) {
-                std::cerr << "Error: Port must be between 1 and 65535" << std::endl;
-                return 1;
-            }
-        } catch (const std::exception& e) {
-            std::cerr << "Error: Invalid port number '" << argv[1] << "'" << std::endl;
-            return 1;
-        }
+
+    if (!ParseServerConfig(argc, argv, server_config)) {
+        return 1;
     }
+    int port = server_config.port;
+    bool use_simulation = server_config.threading == ServerConfig::Threading::kSimulation;
+
+    // One thread per CPU by default; in simulation mode the game thread takes one of them.
+    std::vector<int> cpus = thread_affinity::AllowedCpus();
+    int cpu_count = static_cast<int>(cpus.size());
+    int workers_num = server_config.workers > 0 ? server_config.workers
+                                                : std::max(1, cpu_count - (use_simulation ? 1 : 0));
+    auto cpu_for = [&](int thread_index) {
+        return server_config.pin_threads ? cpus[thread_index % cpu_count] : -1;
+    };
 
     std::cout << "Starting server on port " << port << " with " << workers_num << " workers" << std::endl;
 
     std::vector<std::shared_ptr<ServerWorker>> workers;
     grid = std::make_shared<Grid>(grid_height, grid_width, grid_cell_size);
 
+    if (server_config.balance != ServerConfig::Balance::kReusePort) {
+        balancer = std::make_shared<ConnectionBalancer>(workers_num,
+            server_config.balance == ServerConfig::Balance::kTickTime ? ConnectionBalancer::Policy::kTickTime
+                                                                      : ConnectionBalancer::Policy::kClients);
+    }
+
+    // Each worker owns the snowballs its clients throw; hits from other workers go through mailboxes
+    if (!use_simulation && workers_num > 1) {
+        mailboxes = std::make_shared<WorkerMailboxes>(workers_num);
+    }
+
+    if (server_config.trace_events > 0 && kProfileLevel < PROFILE_LEVEL_TRACING) {
+        std::cerr << "Warning: --trace-events needs a profiling build (PROFILE_LEVEL=3); ignoring it" << std::endl;
+    } else if (server_config.trace_events > 0) {
+        Tracer::instance().Enable(server_config.trace_events);
+        Tracer::instance().InstallDumpSignal();
+        std::cout << "Tracing " << server_config.trace_events << " spans per thread; "
+                  << "kill -USR2 " << getpid() << " writes the last "
+                  << constants::TRACE_WINDOW_MS << " ms as Chrome trace JSON" << std::endl;
+    }
+
+    if (server_config.cpu_profile_hz > 0) {
+        CpuProfiler::instance().Enable(server_config.cpu_profile_hz, constants::CPU_PROFILE_MAX_SECONDS);
+        std::cout << "CPU profiler ready; kill -USR1 " << getpid()
+                  << " starts and stops sampling at " << server_config.cpu_profile_hz << " Hz" << std::endl;
+    }
+
+    // After the CPU profiler is enabled: pool threads register with it as they start
+    if (server_config.view_threads > 0) {
+        view_pool = std::make_shared<TaskPool>(server_config.view_threads, "View");
+        std::cout << "Snapshot builds run on a pool of " << server_config.view_threads << " threads" << std::endl;
+    }
+
+    connection_stats = std::make_shared<ConnectionStatsBoard>(workers_num);
+
+    std::unique_ptr<Simulation> simulation;
+    if (use_simulation) {
+        simulation = std::make_unique<Simulation>();
+        std::cout << "Game logic runs on a dedicated simulation thread" << std::endl;
+    }
+
     for (int i = 0; i < workers_num; i++) {
-        workers.push_back(std::make_shared<ServerWorker>());
-        workers[i]->Start(port);
+        workers.push_back(std::make_shared<ServerWorker>(i, simulation.get()));
+        workers[i]->Start(port, cpu_for(i));
+    }
+    if (simulation) {
+        simulation->Start(cpu_for(workers_num));
+    }
+
+    AdminServer admin;
+    if (server_config.metrics_port > 0) {
+        admin.Start(server_config.metrics_address, server_config.metrics_port);
     }
 
-    // Profiling report loop
+    // Report loop: refreshes /metrics and writes requested traces and CPU
+    // profiles every second, and prints the profiling report every 60 seconds
     int report_interval = 0;
     while (true) {
-        std::this_thread::sleep_for(std::chrono::seconds(10));
+        std::this_thread::sleep_for(std::chrono::seconds(1));
         report_interval++;
+        MetricsExporter::instance().Refresh();
+        std::string trace = Tracer::instance().DumpIfRequested(constants::TRACE_WINDOW_MS);
+        if (!trace.empty()) {
+            std::unique_lock<std::shared_mutex> lock(output_mtx);
+            std::cout << "Trace written to " << trace << std::endl;
+        }
+        bool was_profiling = CpuProfiler::instance().running();
+        std::string cpu_profile = CpuProfiler::instance().Poll();
+        if (!was_profiling && CpuProfiler::instance().running()) {
+            std::unique_lock<std::shared_mutex> lock(output_mtx);
+            std::cout << "CPU profiling started" << std::endl;
+        } else if (!cpu_profile.empty()) {
+            std::unique_lock<std::shared_mutex> lock(output_mtx);
+            std::cout << "CPU profile written to " << cpu_profile << std::endl;
+        }
         
-        // Print profiling report every 60 seconds
-        if (report_interval % 6 == 0) {
+        if (report_interval % 60 == 0) {
             std::unique_lock<std::shared_mutex> lock(output_mtx);
             std::cout << "\n";
-            Profiler::instance().print_report();
+            if (kProfileLevel >= PROFILE_LEVEL_TIMING) {
+                Profiler::instance().print_report();
+                grid->PrintLockHeatmap(std::cout);
+            }
             SystemMonitor::instance().print_stats();
+            connection_stats->Print(std::cout, constants::WORST_CLIENTS_REPORTED);
+            MetricsExporter::instance().FoldInterval();
             Profiler::instance().reset();
         }
     }
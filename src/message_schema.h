@@ -0,0 +1,106 @@
+#ifndef MESSAGE_SCHEMA_H
+#define MESSAGE_SCHEMA_H
+
+#include <cstdint>
+#include <string_view>
+
+#include "schema.h"
+
+// Every message the server reads or writes, defined once as
+// F(type, member, "wireKey") tables. The JSON/msgpack codecs in schema.h and the
+// load-test client's benchmark/schema.js (regenerate with `make schema`) are
+// derived from these tables; adding or renaming a field here updates all of them.
+
+struct Vec2 {
+#define VEC2_FIELDS(F)                                                          \
+    F(double, x, "x")                                                           \
+    F(double, y, "y")
+    SNOWFIGHT_SCHEMA(VEC2_FIELDS)
+
+    [[nodiscard]] bool complete() const { return has(Field::x) && has(Field::y); }
+};
+
+// Client -> server (JSON text). One table covers join, movement and ping;
+// `type` selects which of the other fields apply.
+struct ClientMessage {
+#define CLIENT_MESSAGE_FIELDS(F)                                                \
+    F(std::string_view, type, "type")                                           \
+    F(std::string_view, id, "id")                                               \
+    F(std::string_view, username, "username")                                   \
+    F(std::string_view, object_type, "objectType")                              \
+    F(Vec2, position, "position")                                               \
+    F(Vec2, velocity, "velocity")                                               \
+    F(int, health, "health")                                                    \
+    F(double, size, "size")                                                     \
+    F(long long, time_update, "timeUpdate")                                     \
+    F(long long, life_length, "lifeLength")                                     \
+    F(int, damage, "damage")                                                    \
+    F(bool, charging, "charging")                                               \
+    F(long long, client_time, "clientTime")                                     \
+    F(std::string_view, snapshot_codec, "snapshotCodec")
+    SNOWFIGHT_SCHEMA(CLIENT_MESSAGE_FIELDS)
+};
+
+// Server -> client reply to ping (JSON text).
+struct PongMessage {
+#define PONG_MESSAGE_FIELDS(F)                                                  \
+    F(std::string_view, message_type, "messageType")                            \
+    F(long long, server_time, "serverTime")                                     \
+    F(long long, client_time, "clientTime")
+    SNOWFIGHT_SCHEMA(PONG_MESSAGE_FIELDS)
+};
+
+// Server -> client snapshot (msgpack map). The list values are packed by
+// InterestSet and the event queue; the schema owns their keys.
+struct BatchUpdate {
+#define BATCH_UPDATE_FIELDS(F)                                                  \
+    F(std::string_view, message_type, "messageType")                            \
+    F(long long, timestamp, "timestamp")                                        \
+    F(schema::Deferred, spawns, "spawns")                                       \
+    F(schema::Deferred, updates, "updates")                                     \
+    F(schema::Deferred, despawns, "despawns")                                   \
+    F(schema::Deferred, events, "events")
+    SNOWFIGHT_SCHEMA(BATCH_UPDATE_FIELDS)
+};
+
+// batch_update.spawns[i] (msgpack array): static fields, sent once per slot.
+struct SpawnEntry {
+#define SPAWN_ENTRY_FIELDS(F)                                                   \
+    F(uint16_t, slot, "slot")                                                   \
+    F(std::string_view, id, "id")                                               \
+    F(std::string_view, object_type, "objectType")                              \
+    F(std::string_view, username, "username")                                   \
+    F(double, size, "size")
+    SNOWFIGHT_SCHEMA(SPAWN_ENTRY_FIELDS)
+};
+
+// batch_update.updates[i] (msgpack array): per-tick state keyed by slot.
+struct UpdateEntry {
+#define UPDATE_ENTRY_FIELDS(F)                                                  \
+    F(uint16_t, slot, "slot")                                                   \
+    F(double, x, "x")                                                           \
+    F(double, y, "y")                                                           \
+    F(double, vx, "vx")                                                         \
+    F(double, vy, "vy")                                                         \
+    F(bool, charging, "charging")                                               \
+    F(long long, expire_date, "expireDate")                                     \
+    F(bool, is_dead, "isDead")                                                  \
+    F(long long, time_update, "timeUpdate")                                     \
+    F(int, health, "newHealth")
+    SNOWFIGHT_SCHEMA(UPDATE_ENTRY_FIELDS)
+};
+
+// batch_update.events[i] (msgpack array): hits and deaths for the receiving
+// client, delivered with its next batch_update.
+struct GameEvent {
+    enum Type : uint8_t { kHit = 0, kDeath = 1 };
+
+#define GAME_EVENT_FIELDS(F)                                                    \
+    F(Type, type, "type")                                                       \
+    F(int, health, "newHealth")                                                 \
+    F(int, damage, "damage")                                                    \
+    F(long long, time, "timeUpdate")
+    SNOWFIGHT_SCHEMA(GAME_EVENT_FIELDS)
+};
+
+#endif
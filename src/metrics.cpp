@@ -0,0 +1,169 @@
+#include "metrics.h"
+
+#include <cstdio>
+#include <vector>
+
+// Histogram bounds for scope durations: 10 us .. 100 ms, then +Inf
+static const struct {
+    long long us;
+    const char *label;  // In seconds, as Prometheus expects
+} kScopeBuckets[] = {
+    {10, "1e-05"}, {25, "2.5e-05"}, {50, "5e-05"}, {100, "0.0001"}, {250, "0.00025"},
+    {500, "0.0005"}, {1000, "0.001"}, {2500, "0.0025"}, {5000, "0.005"},
+    {10000, "0.01"}, {25000, "0.025"}, {50000, "0.05"}, {100000, "0.1"},
+};
+
+// SystemMonitor fields that only grow (SystemMonitor::reset() is not called
+// by the server), exported as counters
+static const struct {
+    const char *name;
+    const char *help;
+    size_t SystemMonitor::SystemStats::*field;
+} kCounters[] = {
+    {"snowfight_grid_operations_total", "Grid inserts, removes and moves.",
+     &SystemMonitor::SystemStats::grid_operations},
+    {"snowfight_messages_processed_total", "Client messages handled.",
+     &SystemMonitor::SystemStats::messages_processed},
+    {"snowfight_messages_sent_total", "Frames sent to clients.",
+     &SystemMonitor::SystemStats::messages_sent},
+    {"snowfight_ticks_total", "Game ticks run, across all game threads.",
+     &SystemMonitor::SystemStats::ticks},
+    {"snowfight_tick_overruns_total", "Ticks that took longer than the tick interval.",
+     &SystemMonitor::SystemStats::tick_overruns},
+    {"snowfight_dropped_ticks_total", "Ticks skipped because catch-up was exhausted.",
+     &SystemMonitor::SystemStats::dropped_ticks},
+    {"snowfight_snapshots_shed_total", "Snapshots skipped by load shedding.",
+     &SystemMonitor::SystemStats::snapshots_shed},
+    {"snowfight_snapshots_dropped_backpressure_total", "Snapshots skipped for backpressured clients.",
+     &SystemMonitor::SystemStats::snapshots_dropped_backpressure},
+    {"snowfight_cross_worker_events_total", "Kills posted to another worker's mailbox.",
+     &SystemMonitor::SystemStats::cross_worker_events},
+};
+
+static const struct {
+    const char *name;
+    const char *help;
+    size_t SystemMonitor::SystemStats::*field;
+} kGauges[] = {
+    {"snowfight_active_connections", "Open client connections.",
+     &SystemMonitor::SystemStats::active_connections},
+    {"snowfight_objects", "Objects in the game world.",
+     &SystemMonitor::SystemStats::total_objects},
+    {"snowfight_backpressured_clients", "Clients over the backpressure limit.",
+     &SystemMonitor::SystemStats::backpressured_clients},
+    {"snowfight_inbound_queue_depth", "Commands waiting for the simulation thread.",
+     &SystemMonitor::SystemStats::inbound_queue_depth},
+    {"snowfight_outbound_queue_depth", "Frames waiting for the I/O threads.",
+     &SystemMonitor::SystemStats::outbound_queue_depth},
+    {"snowfight_resident_memory_megabytes", "Resident set size.",
+     &SystemMonitor::SystemStats::memory_usage_mb},
+};
+
+static void Header(std::string& out, const char *name, const char *type, const char *help) {
+    out += "# HELP "; out += name; out += ' '; out += help; out += '\n';
+    out += "# TYPE "; out += name; out += ' '; out += type; out += '\n';
+}
+
+static void Sample(std::string& out, const char *name, const std::string& labels, double value) {
+    char number[32];
+    std::snprintf(number, sizeof(number), "%.15g", value);
+    out += name;
+    if (!labels.empty()) {
+        out += '{'; out += labels; out += '}';
+    }
+    out += ' '; out += number; out += '\n';
+}
+
+// Label values may not contain raw backslashes, quotes or newlines.
+static std::string Escape(const std::string& value) {
+    std::string escaped;
+    escaped.reserve(value.size());
+    for (char c : value) {
+        if (c == '\\' || c == '"') escaped += '\\';
+        if (c == '\n') { escaped += "\\n"; continue; }
+        escaped += c;
+    }
+    return escaped;
+}
+
+void MetricsExporter::FoldInterval() {
+    for (auto& [name, stats] : Profiler::instance().snapshot()) {
+        folded_[name].merge(stats);
+    }
+}
+
+void MetricsExporter::Refresh() {
+    auto text = std::make_shared<const std::string>(Render());
+    std::lock_guard<std::mutex> lock(mtx_);
+    text_ = std::move(text);
+}
+
+std::string MetricsExporter::Render() {
+    std::string out;
+    out.reserve(64 * 1024);
+
+    // Profiler scopes: past intervals plus the current one
+    std::map<std::string, Profiler::Stats> scopes = folded_;
+    for (auto& [name, stats] : Profiler::instance().snapshot()) {
+        scopes[name].merge(stats);
+    }
+    Header(out, "snowfight_scope_duration_seconds", "histogram", "Time spent in each profiled scope.");
+    constexpr size_t kBounds = sizeof(kScopeBuckets) / sizeof(kScopeBuckets[0]);
+    for (const auto& [name, stats] : scopes) {
+        std::string scope = "scope=\"" + Escape(name) + "\"";
+        // Collapse the log-linear buckets; one straddling a bound counts
+        // toward the next bound up (LatencyHistogram is within 6.25%)
+        uint64_t cumulative[kBounds] = {};
+        const LatencyHistogram& histogram = stats.histogram;
+        for (int i = 0; i < LatencyHistogram::kBuckets; i++) {
+            uint64_t count = histogram.count_at(i);
+            if (count == 0) continue;
+            long long upper = LatencyHistogram::BucketUpper(i);
+            for (size_t b = 0; b < kBounds; b++) {
+                if (upper <= kScopeBuckets[b].us) { cumulative[b] += count; break; }
+            }
+        }
+        uint64_t running = 0;
+        for (size_t b = 0; b < kBounds; b++) {
+            running += cumulative[b];
+            Sample(out, "snowfight_scope_duration_seconds_bucket",
+                   scope + ",le=\"" + kScopeBuckets[b].label + "\"", static_cast<double>(running));
+        }
+        Sample(out, "snowfight_scope_duration_seconds_bucket", scope + ",le=\"+Inf\"",
+               static_cast<double>(histogram.count()));
+        Sample(out, "snowfight_scope_duration_seconds_sum", scope, stats.total_time_us / 1e6);
+        Sample(out, "snowfight_scope_duration_seconds_count", scope, static_cast<double>(histogram.count()));
+    }
+
+    auto s = SystemMonitor::instance().get_stats();
+    for (const auto& counter : kCounters) {
+        Header(out, counter.name, "counter", counter.help);
+        Sample(out, counter.name, "", static_cast<double>(s.*counter.field));
+    }
+    Header(out, "snowfight_tick_seconds_total", "counter", "Time spent in game ticks, across all game threads.");
+    Sample(out, "snowfight_tick_seconds_total", "", s.total_tick_us / 1e6);
+
+    for (const auto& gauge : kGauges) {
+        Header(out, gauge.name, "gauge", gauge.help);
+        Sample(out, gauge.name, "", static_cast<double>(s.*gauge.field));
+    }
+    Header(out, "snowfight_cpu_usage_percent", "gauge", "Process CPU since the previous sample; 100 = one core.");
+    Sample(out, "snowfight_cpu_usage_percent", "", s.cpu_usage_percent);
+
+    Header(out, "snowfight_worker_clients", "gauge", "Open connections per worker.");
+    for (size_t i = 0; i < s.worker_clients.size(); i++) {
+        Sample(out, "snowfight_worker_clients", "worker=\"" + std::to_string(i) + "\"",
+               static_cast<double>(s.worker_clients[i]));
+    }
+    Header(out, "snowfight_thread_tick_seconds", "gauge", "Duration of the latest tick, per game thread.");
+    for (size_t i = 0; i < s.thread_tick_us.size(); i++) {
+        Sample(out, "snowfight_thread_tick_seconds", "thread=\"" + std::to_string(i) + "\"",
+               s.thread_tick_us[i] / 1e6);
+    }
+    Header(out, "snowfight_degradation_level", "gauge", "Load shedding level (0-3), per game thread.");
+    for (size_t i = 0; i < s.degradation_levels.size(); i++) {
+        Sample(out, "snowfight_degradation_level", "thread=\"" + std::to_string(i) + "\"",
+               s.degradation_levels[i]);
+    }
+    return out;
+}
@@ -0,0 +1,47 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "profiler.h"
+
+// Prometheus text exposition of the profiler and SystemMonitor, served at
+// GET /metrics by the AdminServer.
+//
+// The text is rendered by the main thread's report loop (Refresh) and cached;
+// the HTTP handler only copies the cached string, so a scrape never merges
+// profiler slabs or takes the monitor's lock.
+//
+// Profiler scopes are exported as cumulative histograms. The profiler itself
+// is reset every report interval, so FoldInterval() adds the interval's stats
+// to a running total first; call it right before Profiler::reset(), from the
+// thread that calls Refresh().
+class MetricsExporter {
+public:
+    static MetricsExporter& instance() {
+        static MetricsExporter inst;
+        return inst;
+    }
+
+    void Refresh();
+    void FoldInterval();
+
+    // Latest rendered text; empty until the first Refresh().
+    [[nodiscard]] std::shared_ptr<const std::string> Current() const {
+        std::lock_guard<std::mutex> lock(mtx_);
+        return text_;
+    }
+
+private:
+    std::string Render();
+
+    std::map<std::string, Profiler::Stats> folded_;  // Scopes of past intervals, by name
+
+    mutable std::mutex mtx_;
+    std::shared_ptr<const std::string> text_ = std::make_shared<const std::string>();
+};
+
+#endif
@@ -0,0 +1,65 @@
+#ifndef MPSC_QUEUE_H
+#define MPSC_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+// Unbounded lock-free multi-producer / single-consumer queue (Vyukov's
+// node-based design). Push is wait-free: one exchange plus one store. Pop
+// must only be called from the single consumer thread. A pushed item can be
+// briefly invisible to Pop while its producer is between the two steps; the
+// consumer just picks it up on its next drain.
+template <typename T>
+class MpscQueue {
+public:
+    MpscQueue() : head_(&stub_), tail_(&stub_) {}
+    ~MpscQueue() {
+        T discard;
+        while (TryPop(discard)) {}
+        if (tail_ != &stub_) delete tail_;
+    }
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    // Safe from any thread.
+    void Push(T value) {
+        Node* node = new Node(std::move(value));
+        // Counted before the node is published, so the consumer's fetch_sub
+        // for it can never come first and wrap the counter
+        size_.fetch_add(1, std::memory_order_relaxed);
+        Node* prev = head_.exchange(node, std::memory_order_acq_rel);
+        prev->next.store(node, std::memory_order_release);
+    }
+
+    // Consumer thread only.
+    bool TryPop(T& out) {
+        Node* tail = tail_;
+        Node* next = tail->next.load(std::memory_order_acquire);
+        if (!next) return false;
+        out = std::move(next->value);
+        tail_ = next;  // next becomes the new stub; its value has been moved out
+        if (tail != &stub_) delete tail;
+        size_.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // Approximate; for instrumentation only.
+    [[nodiscard]] size_t size() const { return size_.load(std::memory_order_relaxed); }
+
+private:
+    struct Node {
+        Node() = default;
+        explicit Node(T v) : value(std::move(v)) {}
+        std::atomic<Node*> next{nullptr};
+        T value{};
+    };
+
+    // Producers and the consumer touch different ends; keep them on separate lines
+    alignas(64) std::atomic<Node*> head_;
+    alignas(64) Node* tail_;
+    alignas(64) std::atomic<size_t> size_{0};
+    Node stub_;
+};
+
+#endif
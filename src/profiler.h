@@ -1,34 +1,108 @@
 #ifndef PROFILER_H
 #define PROFILER_H
 
+#include <time.h>
+#include <unistd.h>
+
+#include <atomic>
 #include <chrono>
+#include <cstdint>
+#include <memory>
 #include <string>
 #include <unordered_map>
 #include <shared_mutex>
+#include <mutex>
+#include <climits>
 #include <iostream>
 #include <iomanip>
 #include <vector>
 #include <algorithm>
+#include <fstream>
+#include <sstream>
+
+#include "histogram.h"
+#include "sharded_counter.h"
+#include "trace.h"
+
+// Instrumentation tier, fixed at build time with -DPROFILE_LEVEL=N (the
+// Makefile builds a production and a profiling binary). Tiers are cumulative;
+// whatever a tier leaves out compiles to nothing.
+//   0 off       no instrumentation; SystemMonitor keeps only its gauges
+//   1 counters  SystemMonitor's hot-path counters (grid ops, messages, ...)
+//   2 timing    PROFILE_SCOPE / PROFILE_FUNCTION / PROFILE_RECORD, TimedLock
+//   3 tracing   span rings for --trace-events
+#define PROFILE_LEVEL_OFF 0
+#define PROFILE_LEVEL_COUNTERS 1
+#define PROFILE_LEVEL_TIMING 2
+#define PROFILE_LEVEL_TRACING 3
+#ifndef PROFILE_LEVEL
+#define PROFILE_LEVEL PROFILE_LEVEL_TRACING
+#endif
+inline constexpr int kProfileLevel = PROFILE_LEVEL;
+
+// Running totals of the calling thread, sampled once per tick by the tick
+// log (tick_log.h). Only the owning thread touches them; work a game thread
+// hands to the view pool is added back to its totals when the loop returns.
+struct ThreadCounters {
+    uint64_t grid_ops = 0;
+    uint64_t bytes_sent = 0;
+    uint64_t lock_wait_ns = 0;
+};
+
+inline ThreadCounters& thread_counters() {
+    thread_local ThreadCounters counters;
+    return counters;
+}
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)  // Expands __LINE__ first
 
-// Simple profiler to track function execution times
+// Low-overhead profiler to track function execution times.
+//
+// Each scope name is registered once (PROFILE_SCOPE keeps the id in a static)
+// and every thread accumulates its samples in its own slab of counters, so
+// recording a sample is a clock read and a few uncontended stores: no lock,
+// no string hashing. print_report() merges the slabs.
+//
+// reset() starts a new interval by bumping an epoch instead of touching other
+// threads' slabs; each thread clears its own slab on its next sample, and
+// slabs still on an old epoch are left out of the merge.
 class Profiler {
 public:
+    using ScopeId = uint32_t;
+    static constexpr ScopeId kMaxScopes = 1024;  // Later names all share the last id
+
     struct Stats {
         long long total_time_us = 0;
         long long min_time_us = LLONG_MAX;
         long long max_time_us = 0;
         long long call_count = 0;
+        LatencyHistogram histogram; // Durations, for percentiles
         
         void add_sample(long long time_us) {
             total_time_us += time_us;
             min_time_us = std::min(min_time_us, time_us);
             max_time_us = std::max(max_time_us, time_us);
             call_count++;
+            histogram.add(time_us);
+        }
+        
+        void merge(const Stats& other) {
+            total_time_us += other.total_time_us;
+            min_time_us = std::min(min_time_us, other.min_time_us);
+            max_time_us = std::max(max_time_us, other.max_time_us);
+            call_count += other.call_count;
+            histogram.merge(other.histogram);
         }
         
         double avg_time_us() const {
             return call_count > 0 ? static_cast<double>(total_time_us) / call_count : 0.0;
         }
+        
+        // e.g. percentile_us(99.9); within 6.25% of the true value
+        long long percentile_us(double percent) const {
+            return histogram.percentile(percent);
+        }
     };
     
     static Profiler& instance() {
@@ -36,29 +110,90 @@ public:
         return inst;
     }
     
-    void record(const std::string& name, long long duration_us) {
-        std::unique_lock<std::shared_mutex> lock(mtx_);
-        stats_[name].add_sample(duration_us);
+    // Returns the id for `name`, registering it on first use. Takes a lock;
+    // call once per site and keep the id (PROFILE_SCOPE does).
+    ScopeId Register(const std::string& name) {
+        std::lock_guard<std::mutex> lock(names_mtx_);
+        auto it = ids_.find(name);
+        if (it != ids_.end()) return it->second;
+        ScopeId id = kMaxScopes - 1;
+        if (names_.size() < kMaxScopes - 1) {
+            id = static_cast<ScopeId>(names_.size());
+            names_.push_back(name);
+        } else if (names_.size() == kMaxScopes - 1) {
+            names_.push_back("(other)");
+        }
+        ids_.emplace(name, id);
+        return id;
     }
     
+    // Any thread, lock-free.
+    void record(ScopeId id, long long duration_us) {
+        Slab& slab = local_slab();
+        uint64_t epoch = epoch_.load(std::memory_order_relaxed);
+        if (slab.epoch.load(std::memory_order_relaxed) != epoch) slab.clear(epoch);
+        slab.scopes[id].add_sample(duration_us);
+    }
+    
+    // Merged stats of the current interval, by scope name.
+    std::vector<std::pair<std::string, Stats>> snapshot() {
+        size_t scopes;
+        {
+            std::lock_guard<std::mutex> lock(names_mtx_);
+            scopes = names_.size();
+        }
+        std::vector<Stats> merged(scopes);
+        uint64_t epoch = epoch_.load(std::memory_order_acquire);
+        {
+            std::lock_guard<std::mutex> lock(slabs_mtx_);
+            for (const auto& slab : slabs_) {
+                if (slab->epoch.load(std::memory_order_acquire) != epoch) continue;
+                for (ScopeId id = 0; id < scopes; id++) {
+                    slab->scopes[id].merge_into(merged[id]);
+                }
+            }
+        }
+        std::vector<std::pair<std::string, Stats>> result;
+        std::lock_guard<std::mutex> lock(names_mtx_);
+        for (ScopeId id = 0; id < scopes; id++) {
+            if (merged[id].call_count > 0 && id != calibration_id_) result.push_back({names_[id], merged[id]});
+        }
+        return result;
+    }
+    
+    // Scope names indexed by id; the calibration scope's name is empty.
+    std::vector<std::string> names() {
+        std::lock_guard<std::mutex> lock(names_mtx_);
+        std::vector<std::string> result = names_;
+        if (calibration_id_ < result.size()) result[calibration_id_].clear();
+        return result;
+    }
+    
+    // Mean cost of one PROFILE_SCOPE (both clock reads plus record), measured
+    // once on first use.
+    double overhead_ns();
+    
     void print_report() {
-        std::shared_lock<std::shared_mutex> lock(mtx_);
+        double overhead = overhead_ns();
+        auto sorted_stats = snapshot();
         
-        std::cout << "\n" << std::string(80, '=') << "\n";
+        std::cout << "\n" << std::string(130, '=') << "\n";
         std::cout << "PROFILING REPORT\n";
-        std::cout << std::string(80, '=') << "\n\n";
+        std::cout << "(profiler overhead: " << std::fixed << std::setprecision(1) << overhead
+                  << " ns per scope; percentiles in us)\n";
+        std::cout << std::string(130, '=') << "\n\n";
         
-        // Create sorted vector by total time
-        std::vector<std::pair<std::string, Stats>> sorted_stats;
         long long total_lock_wait_time = 0;
+        long long total_lock_hold_time = 0;
         long long total_lock_calls = 0;
         
-        for (const auto& [name, stat] : stats_) {
-            sorted_stats.push_back({name, stat});
-            // Accumulate lock wait statistics
+        for (const auto& [name, stat] : sorted_stats) {
+            // Accumulate lock statistics (TimedLock, lock_stats.h)
             if (name.substr(0, 10) == "LOCK_WAIT:") {
                 total_lock_wait_time += stat.total_time_us;
                 total_lock_calls += stat.call_count;
+            } else if (name.substr(0, 10) == "LOCK_HOLD:") {
+                total_lock_hold_time += stat.total_time_us;
             }
         }
         std::sort(sorted_stats.begin(), sorted_stats.end(),
@@ -71,8 +206,12 @@ public:
                   << std::setw(12) << "Total(ms)"
                   << std::setw(12) << "Avg(us)"
                   << std::setw(12) << "Min(us)"
-                  << std::setw(12) << "Max(us)" << "\n";
-        std::cout << std::string(80, '-') << "\n";
+                  << std::setw(12) << "Max(us)"
+                  << std::setw(10) << "P50"
+                  << std::setw(10) << "P90"
+                  << std::setw(10) << "P99"
+                  << std::setw(10) << "P99.9" << "\n";
+        std::cout << std::string(130, '-') << "\n";
         
         for (const auto& [name, stat] : sorted_stats) {
             std::cout << std::left << std::setw(30) << name
@@ -82,10 +221,14 @@ public:
                       << std::setw(12) << std::fixed << std::setprecision(2) 
                       << stat.avg_time_us()
                       << std::setw(12) << stat.min_time_us
-                      << std::setw(12) << stat.max_time_us << "\n";
+                      << std::setw(12) << stat.max_time_us
+                      << std::setw(10) << stat.percentile_us(50)
+                      << std::setw(10) << stat.percentile_us(90)
+                      << std::setw(10) << stat.percentile_us(99)
+                      << std::setw(10) << stat.percentile_us(99.9) << "\n";
         }
         
-        std::cout << "\n" << std::string(80, '=') << "\n";
+        std::cout << "\n" << std::string(130, '=') << "\n";
         
         // Print lock contention summary
         if (total_lock_calls > 0) {
@@ -98,59 +241,175 @@ public:
                       << std::fixed << std::setprecision(2)
                       << (static_cast<double>(total_lock_wait_time) / total_lock_calls) 
                       << " μs\n";
+            std::cout << "Total Time Holding Locks: "
+                      << std::fixed << std::setprecision(2)
+                      << (total_lock_hold_time / 1000.0) << " ms\n";
             std::cout << "===============================\n";
         }
         
-        std::cout << "\n" << std::string(80, '=') << "\n\n";
+        std::cout << "\n" << std::string(130, '=') << "\n\n";
     }
     
     void reset() {
-        std::unique_lock<std::shared_mutex> lock(mtx_);
-        stats_.clear();
+        epoch_.fetch_add(1, std::memory_order_acq_rel);
     }
     
 private:
-    std::unordered_map<std::string, Stats> stats_;
-    std::shared_mutex mtx_;
+    // One scope's counters in one thread's slab. Only the owning thread
+    // writes (plain load + store, no read-modify-write); the report reads
+    // them concurrently, hence the relaxed atomics.
+    struct ScopeCounters {
+        std::atomic<long long> total_time_us{0};
+        std::atomic<long long> min_time_us{LLONG_MAX};
+        std::atomic<long long> max_time_us{0};
+        std::atomic<long long> call_count{0};
+        // Histogram buckets, allocated on the scope's first sample on this thread
+        std::atomic<std::atomic<uint64_t> *> buckets{nullptr};
+        
+        ~ScopeCounters() { delete[] buckets.load(std::memory_order_relaxed); }
+        
+        void add_sample(long long time_us) {
+            auto relaxed = std::memory_order_relaxed;
+            total_time_us.store(total_time_us.load(relaxed) + time_us, relaxed);
+            if (time_us < min_time_us.load(relaxed)) min_time_us.store(time_us, relaxed);
+            if (time_us > max_time_us.load(relaxed)) max_time_us.store(time_us, relaxed);
+            call_count.store(call_count.load(relaxed) + 1, relaxed);
+            
+            auto *counts = buckets.load(relaxed);
+            if (!counts) {
+                counts = new std::atomic<uint64_t>[LatencyHistogram::kBuckets]();
+                buckets.store(counts, std::memory_order_release);
+            }
+            auto& count = counts[LatencyHistogram::BucketOf(time_us)];
+            count.store(count.load(relaxed) + 1, relaxed);
+        }
+        
+        void merge_into(Stats& stats) const {
+            auto relaxed = std::memory_order_relaxed;
+            long long calls = call_count.load(relaxed);
+            if (calls == 0) return;
+            stats.total_time_us += total_time_us.load(relaxed);
+            stats.min_time_us = std::min(stats.min_time_us, min_time_us.load(relaxed));
+            stats.max_time_us = std::max(stats.max_time_us, max_time_us.load(relaxed));
+            stats.call_count += calls;
+            if (auto *counts = buckets.load(std::memory_order_acquire)) {
+                for (int i = 0; i < LatencyHistogram::kBuckets; i++) {
+                    uint64_t count = counts[i].load(relaxed);
+                    if (count) stats.histogram.add_bucket(i, count);
+                }
+            }
+        }
+        
+        void clear() {
+            auto relaxed = std::memory_order_relaxed;
+            total_time_us.store(0, relaxed);
+            min_time_us.store(LLONG_MAX, relaxed);
+            max_time_us.store(0, relaxed);
+            call_count.store(0, relaxed);
+            if (auto *counts = buckets.load(relaxed)) {
+                for (int i = 0; i < LatencyHistogram::kBuckets; i++) counts[i].store(0, relaxed);
+            }
+        }
+    };
+    
+    struct Slab {
+        std::atomic<uint64_t> epoch{0};
+        ScopeCounters scopes[kMaxScopes];
+        
+        void clear(uint64_t new_epoch) {
+            for (auto& scope : scopes) scope.clear();
+            epoch.store(new_epoch, std::memory_order_release);
+        }
+    };
+    
+    // This thread's slab, created and registered on first use. Slabs are kept
+    // after their thread exits so its samples still count in the interval.
+    Slab& local_slab() {
+        thread_local Slab *slab = nullptr;
+        if (!slab) {
+            auto owned = std::make_unique<Slab>();
+            owned->epoch.store(epoch_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            slab = owned.get();
+            std::lock_guard<std::mutex> lock(slabs_mtx_);
+            slabs_.push_back(std::move(owned));
+        }
+        return *slab;
+    }
+    
+    std::mutex names_mtx_;
+    std::vector<std::string> names_;
+    std::unordered_map<std::string, ScopeId> ids_;
+    ScopeId calibration_id_ = kMaxScopes;  // Excluded from reports
+    
+    std::mutex slabs_mtx_;
+    std::vector<std::unique_ptr<Slab>> slabs_;
+    std::atomic<uint64_t> epoch_{1};
 };
 
+// Registers `name` once per call site and yields its id. `name` must be a
+// string literal or __FUNCTION__ (taken from the caller, so it still names
+// the enclosing function); the static makes every later call a load.
+#define PROFILE_ID(name) \
+    [](const char *profile_name_) { \
+        static const Profiler::ScopeId profile_id_ = Profiler::instance().Register(profile_name_); \
+        return profile_id_; \
+    }(name)
+
 // RAII timer for automatic profiling
 class ScopedTimer {
 public:
-    explicit ScopedTimer(const std::string& name) 
-        : name_(name), start_(std::chrono::high_resolution_clock::now()) {}
+    explicit ScopedTimer(Profiler::ScopeId id) 
+        : id_(id), start_(std::chrono::steady_clock::now()) {}
     
     ~ScopedTimer() {
-        auto end = std::chrono::high_resolution_clock::now();
+        auto end = std::chrono::steady_clock::now();
         auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start_).count();
-        Profiler::instance().record(name_, duration);
+        Profiler::instance().record(id_, duration);
+        if constexpr (kProfileLevel >= PROFILE_LEVEL_TRACING) {
+            if (Tracer::instance().enabled()) Tracer::instance().record(id_, start_, end);
+        }
     }
     
 private:
-    std::string name_;
-    std::chrono::high_resolution_clock::time_point start_;
+    Profiler::ScopeId id_;
+    std::chrono::steady_clock::time_point start_;
 };
 
 // Macro for easy profiling
-#define PROFILE_SCOPE(name) ScopedTimer _timer_##__LINE__(name)
-#define PROFILE_FUNCTION() ScopedTimer _timer_##__LINE__(__FUNCTION__)
+#if PROFILE_LEVEL >= PROFILE_LEVEL_TIMING
+#define PROFILE_SCOPE(name) ScopedTimer PROFILE_CONCAT(_timer_, __LINE__)(PROFILE_ID(name))
+#define PROFILE_FUNCTION() ScopedTimer PROFILE_CONCAT(_timer_, __LINE__)(PROFILE_ID(__FUNCTION__))
+// A sample measured by the caller, e.g. time spent in a queue
+#define PROFILE_RECORD(name, duration_us) Profiler::instance().record(PROFILE_ID(name), (duration_us))
+#else
+#define PROFILE_SCOPE(name) ((void)0)
+#define PROFILE_FUNCTION() ((void)0)
+#define PROFILE_RECORD(name, duration_us) ((void)0)
+#endif
+
+inline double Profiler::overhead_ns() {
+    static const double overhead = [this] {
+        ScopeId id = Register("(profiler calibration)");
+        {
+            std::lock_guard<std::mutex> lock(names_mtx_);
+            calibration_id_ = id;
+        }
+        // Thread CPU time, so being preempted by busy workers doesn't count
+        auto cpu_ns = [] {
+            timespec ts;
+            clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+            return ts.tv_sec * 1e9 + ts.tv_nsec;
+        };
+        constexpr int kIterations = 100000;
+        double start = cpu_ns();
+        for (int i = 0; i < kIterations; i++) {
+            ScopedTimer timer(id);
+        }
+        return (cpu_ns() - start) / kIterations;
+    }();
+    return overhead;
+}
 
-// RAII timer for lock contention measurement
-class LockTimer {
-public:
-    explicit LockTimer(const std::string& lock_name) 
-        : name_(lock_name), start_(std::chrono::high_resolution_clock::now()) {}
-    
-    ~LockTimer() {
-        auto end = std::chrono::high_resolution_clock::now();
-        auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start_).count();
-        Profiler::instance().record("LOCK_WAIT:" + name_, duration);
-    }
-    
-private:
-    std::string name_;
-    std::chrono::high_resolution_clock::time_point start_;
-};
 
 // Memory and system statistics
 class SystemMonitor {
@@ -161,8 +420,30 @@ public:
         size_t grid_operations = 0;
         size_t messages_processed = 0;
         size_t messages_sent = 0;
-        double cpu_usage_percent = 0.0;
-        size_t memory_usage_mb = 0;
+        double cpu_usage_percent = 0.0;  // Process CPU since the previous sample; 100 = one core
+        size_t memory_usage_mb = 0;      // Resident set size
+        // Simulation mode: commands waiting for the simulation thread and
+        // frames waiting for the I/O threads, sampled once per tick
+        size_t inbound_queue_depth = 0;
+        size_t max_inbound_queue_depth = 0;
+        size_t outbound_queue_depth = 0;
+        size_t max_outbound_queue_depth = 0;
+        std::vector<size_t> worker_clients; // Open connections per worker
+        // Fixed-timestep ticks across all game threads
+        size_t ticks = 0;
+        size_t tick_overruns = 0;    // Ticks that took longer than the tick interval
+        size_t dropped_ticks = 0;    // Skipped because catch-up was exhausted
+        long long total_tick_us = 0;
+        long long max_tick_us = 0;
+        // Load shedding (DegradationController), per game thread
+        std::vector<int> degradation_levels;
+        std::vector<long long> thread_tick_us;  // Latest tick duration, per game thread
+        size_t snapshots_shed = 0;
+        // Slow readers: sockets over the backpressure limit right now, and
+        // snapshots skipped for them
+        size_t backpressured_clients = 0;
+        size_t snapshots_dropped_backpressure = 0;
+        size_t cross_worker_events = 0;  // Kills posted to another worker's mailbox
     };
     
     static SystemMonitor& instance() {
@@ -185,45 +466,224 @@ public:
         stats_.total_objects = count;
     }
     
+    // Hot-path counters: sharded per thread, no lock; compiled out below
+    // PROFILE_LEVEL_COUNTERS.
     void increment_grid_ops() {
+        if constexpr (kCounting) {
+            grid_operations_.add();
+            thread_counters().grid_ops++;
+        }
+    }
+    void increment_msg_processed() { if constexpr (kCounting) messages_processed_.add(); }
+    void increment_msg_sent() { if constexpr (kCounting) messages_sent_.add(); }
+    // Per thread only, for the tick log
+    void add_bytes_sent(size_t bytes) { if constexpr (kCounting) thread_counters().bytes_sent += bytes; }
+    
+    void set_inbound_queue_depth(size_t depth) {
+        std::unique_lock<std::shared_mutex> lock(mtx_);
+        stats_.inbound_queue_depth = depth;
+        stats_.max_inbound_queue_depth = std::max(stats_.max_inbound_queue_depth, depth);
+    }
+    
+    void set_outbound_queue_depth(size_t depth) {
+        std::unique_lock<std::shared_mutex> lock(mtx_);
+        stats_.outbound_queue_depth = depth;
+        stats_.max_outbound_queue_depth = std::max(stats_.max_outbound_queue_depth, depth);
+    }
+    
+    void record_tick(long long duration_us, bool overrun) {
+        std::unique_lock<std::shared_mutex> lock(mtx_);
+        stats_.ticks++;
+        if (overrun) stats_.tick_overruns++;
+        stats_.total_tick_us += duration_us;
+        stats_.max_tick_us = std::max(stats_.max_tick_us, duration_us);
+    }
+    
+    void add_dropped_ticks(size_t count) {
+        std::unique_lock<std::shared_mutex> lock(mtx_);
+        stats_.dropped_ticks += count;
+    }
+    
+    void set_degradation_level(size_t thread, int level) {
+        std::unique_lock<std::shared_mutex> lock(mtx_);
+        if (stats_.degradation_levels.size() <= thread) {
+            stats_.degradation_levels.resize(thread + 1);
+        }
+        stats_.degradation_levels[thread] = level;
+    }
+    
+    void record_thread_tick(size_t thread, long long duration_us) {
         std::unique_lock<std::shared_mutex> lock(mtx_);
-        stats_.grid_operations++;
+        if (stats_.thread_tick_us.size() <= thread) {
+            stats_.thread_tick_us.resize(thread + 1);
+        }
+        stats_.thread_tick_us[thread] = duration_us;
     }
     
-    void increment_msg_processed() {
+    void add_snapshots_shed(size_t count) {
         std::unique_lock<std::shared_mutex> lock(mtx_);
-        stats_.messages_processed++;
+        stats_.snapshots_shed += count;
     }
     
-    void increment_msg_sent() {
+    void client_backpressured(bool on) {
         std::unique_lock<std::shared_mutex> lock(mtx_);
-        stats_.messages_sent++;
+        if (on) stats_.backpressured_clients++;
+        else if (stats_.backpressured_clients > 0) stats_.backpressured_clients--;
+    }
+    
+    void add_snapshots_dropped_backpressure(size_t count) {
+        std::unique_lock<std::shared_mutex> lock(mtx_);
+        stats_.snapshots_dropped_backpressure += count;
+    }
+    
+    void increment_cross_worker_events() { if constexpr (kCounting) cross_worker_events_.add(); }
+    
+    void set_worker_clients(size_t worker, size_t count) {
+        std::unique_lock<std::shared_mutex> lock(mtx_);
+        if (stats_.worker_clients.size() <= worker) {
+            stats_.worker_clients.resize(worker + 1);
+        }
+        stats_.worker_clients[worker] = count;
     }
     
     SystemStats get_stats() {
-        std::shared_lock<std::shared_mutex> lock(mtx_);
-        return stats_;
+        SystemStats stats;
+        {
+            std::shared_lock<std::shared_mutex> lock(mtx_);
+            stats = stats_;
+            stats.grid_operations = grid_operations_.load() - grid_operations_base_;
+            stats.messages_processed = messages_processed_.load() - messages_processed_base_;
+            stats.messages_sent = messages_sent_.load() - messages_sent_base_;
+            stats.cross_worker_events = cross_worker_events_.load() - cross_worker_events_base_;
+        }
+        SampleProcess(stats);
+        return stats;
     }
     
     void print_stats() {
         auto s = get_stats();
         std::cout << "\n=== SYSTEM STATISTICS ===\n"
+                  << "CPU Usage: " << std::fixed << std::setprecision(1) << s.cpu_usage_percent << "%\n"
+                  << "Memory Usage: " << s.memory_usage_mb << " MB\n"
                   << "Active Connections: " << s.active_connections << "\n"
                   << "Total Objects: " << s.total_objects << "\n"
                   << "Grid Operations: " << s.grid_operations << "\n"
                   << "Messages Processed: " << s.messages_processed << "\n"
                   << "Messages Sent: " << s.messages_sent << "\n"
-                  << "=========================\n\n";
+                  << "Inbound Queue Depth: " << s.inbound_queue_depth
+                  << " (max " << s.max_inbound_queue_depth << ")\n"
+                  << "Outbound Queue Depth: " << s.outbound_queue_depth
+                  << " (max " << s.max_outbound_queue_depth << ")\n";
+        std::cout << "Ticks: " << s.ticks
+                  << " (avg " << std::fixed << std::setprecision(1)
+                  << (s.ticks ? static_cast<double>(s.total_tick_us) / s.ticks : 0.0)
+                  << " us, max " << s.max_tick_us << " us)\n"
+                  << "Tick Overruns: " << s.tick_overruns << "\n"
+                  << "Dropped Ticks: " << s.dropped_ticks << "\n"
+                  << "Backpressured Clients: " << s.backpressured_clients
+                  << " (snapshots dropped: " << s.snapshots_dropped_backpressure << ")\n"
+                  << "Cross-worker Events: " << s.cross_worker_events << "\n";
+        if (!s.degradation_levels.empty()) {
+            std::cout << "Degradation Level:";
+            for (int level : s.degradation_levels) std::cout << " " << level;
+            std::cout << " (snapshots shed: " << s.snapshots_shed << ")\n";
+        }
+        if (!s.worker_clients.empty()) {
+            std::cout << "Clients per Worker:";
+            for (size_t count : s.worker_clients) std::cout << " " << count;
+            std::cout << "\n";
+        }
+        std::cout << "=========================\n\n";
     }
     
     void reset() {
         std::unique_lock<std::shared_mutex> lock(mtx_);
+        auto worker_clients = std::move(stats_.worker_clients);
+        auto degradation_levels = std::move(stats_.degradation_levels);
+        auto thread_tick_us = std::move(stats_.thread_tick_us);
+        size_t backpressured_clients = stats_.backpressured_clients;
+        size_t active_connections = stats_.active_connections;
+        size_t total_objects = stats_.total_objects;
         stats_ = SystemStats{};
+        // Gauges, not counters
+        stats_.active_connections = active_connections;
+        stats_.total_objects = total_objects;
+        stats_.backpressured_clients = backpressured_clients;
+        stats_.worker_clients = std::move(worker_clients);
+        stats_.degradation_levels = std::move(degradation_levels);
+        stats_.thread_tick_us = std::move(thread_tick_us);
+        // Sharded counters keep counting; the interval starts from here
+        grid_operations_base_ = grid_operations_.load();
+        messages_processed_base_ = messages_processed_.load();
+        messages_sent_base_ = messages_sent_.load();
+        cross_worker_events_base_ = cross_worker_events_.load();
     }
     
 private:
+    static constexpr bool kCounting = kProfileLevel >= PROFILE_LEVEL_COUNTERS;
+    
+    // Fills in CPU and memory from /proc/self (Linux; left at 0 elsewhere).
+    // CPU is averaged since the previous sample, taken at most once a second.
+    void SampleProcess(SystemStats& stats) {
+        std::lock_guard<std::mutex> lock(process_mtx_);
+        auto now = std::chrono::steady_clock::now();
+        if (now - last_sample_time_ >= std::chrono::seconds(1)) {
+            double cpu_seconds = ProcessCpuSeconds();
+            if (last_cpu_seconds_ >= 0) {
+                double wall = std::chrono::duration<double>(now - last_sample_time_).count();
+                cpu_usage_percent_ = 100.0 * (cpu_seconds - last_cpu_seconds_) / wall;
+            }
+            last_cpu_seconds_ = cpu_seconds;
+            last_sample_time_ = now;
+            memory_usage_mb_ = ResidentBytes() / (1024 * 1024);
+        }
+        stats.cpu_usage_percent = cpu_usage_percent_;
+        stats.memory_usage_mb = memory_usage_mb_;
+    }
+    
+    // utime + stime from /proc/self/stat, or -1.
+    static double ProcessCpuSeconds() {
+        std::ifstream file("/proc/self/stat");
+        std::string line;
+        if (!std::getline(file, line)) return -1;
+        // Fields after the parenthesised command name, which may contain spaces
+        size_t paren = line.rfind(')');
+        if (paren == std::string::npos) return -1;
+        std::istringstream fields(line.substr(paren + 2));
+        std::string field;
+        unsigned long long utime = 0, stime = 0;
+        for (int i = 3; i <= 15 && fields >> field; i++) {
+            if (i == 14) utime = std::stoull(field);
+            if (i == 15) stime = std::stoull(field);
+        }
+        return static_cast<double>(utime + stime) / sysconf(_SC_CLK_TCK);
+    }
+    
+    // Resident pages from /proc/self/statm, in bytes.
+    static size_t ResidentBytes() {
+        std::ifstream file("/proc/self/statm");
+        size_t total_pages = 0, resident_pages = 0;
+        if (!(file >> total_pages >> resident_pages)) return 0;
+        return resident_pages * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    }
+    
     SystemStats stats_;
     std::shared_mutex mtx_;
+    
+    ShardedCounter grid_operations_;
+    ShardedCounter messages_processed_;
+    ShardedCounter messages_sent_;
+    ShardedCounter cross_worker_events_;
+    uint64_t grid_operations_base_ = 0;  // Counter values at the last reset()
+    uint64_t messages_processed_base_ = 0;
+    uint64_t messages_sent_base_ = 0;
+    uint64_t cross_worker_events_base_ = 0;
+    
+    std::mutex process_mtx_;
+    std::chrono::steady_clock::time_point last_sample_time_{};
+    double last_cpu_seconds_ = -1;
+    double cpu_usage_percent_ = 0.0;
+    size_t memory_usage_mb_ = 0;
 };
 
 #endif // PROFILER_H
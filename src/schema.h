@@ -0,0 +1,298 @@
+#ifndef SCHEMA_H
+#define SCHEMA_H
+
+#include <charconv>
+#include <cstdio>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include "nlohmann/json.hpp"
+#include "msgpack.hpp"
+
+// Compile-time message schemas.
+//
+// A message is described once by an X-macro field table of
+// F(type, member, "wireKey") entries. SNOWFIGHT_SCHEMA(FIELDS) expands inside a
+// struct to the members, a Field enum, a constexpr kFields table and a
+// hash-switch field setter, from which the generic JSON and msgpack codecs
+// below are instantiated. Decoding walks the input once and dispatches each key
+// through a switch on its compile-time FNV-1a hash; duplicate keys (or hash
+// collisions) fail to compile as duplicate case labels.
+namespace schema {
+    constexpr uint32_t Hash(std::string_view str) {
+        uint32_t hash = 2166136261u;
+        for (char c : str) {
+            hash ^= static_cast<uint8_t>(c);
+            hash *= 16777619u;
+        }
+        return hash;
+    }
+
+    struct FieldInfo {
+        std::string_view key;     // Name on the wire
+        std::string_view member;  // C++ member name
+    };
+
+    // Placeholder type for map entries whose value is written by hand
+    // (e.g. the arrays inside batch_update); only the key comes from the schema.
+    struct Deferred {};
+
+    template <typename T>
+    concept Message = requires { T::kFieldCount; T::kFields; };
+
+    template <typename Enum>
+    constexpr uint32_t Bit(Enum field) { return 1u << static_cast<uint32_t>(field); }
+}
+
+#define SCHEMA_DECLARE_MEMBER(type, member, key) type member{};
+#define SCHEMA_DECLARE_FIELD(type, member, key) member,
+#define SCHEMA_DECLARE_INFO(type, member, key) schema::FieldInfo{key, #member},
+#define SCHEMA_DECODE_CASE(type, member, key)                                   \
+    case schema::Hash(key):                                                     \
+        if (name != key || !read(member)) return false;                         \
+        present |= schema::Bit(Field::member);                                  \
+        return true;
+#define SCHEMA_DECODE_INDEX(type, member, key)                                  \
+    case static_cast<uint32_t>(Field::member):                                  \
+        if (!read(member)) return false;                                        \
+        present |= schema::Bit(Field::member);                                  \
+        return true;
+#define SCHEMA_VISIT(type, member, key) visitor(std::string_view(key), member);
+
+#define SNOWFIGHT_SCHEMA(FIELDS)                                                \
+    FIELDS(SCHEMA_DECLARE_MEMBER)                                               \
+    uint32_t present = 0;                                                       \
+    enum class Field : uint32_t { FIELDS(SCHEMA_DECLARE_FIELD) kCount };        \
+    static constexpr size_t kFieldCount = static_cast<size_t>(Field::kCount);   \
+    static constexpr schema::FieldInfo kFields[] = { FIELDS(SCHEMA_DECLARE_INFO) }; \
+    static_assert(kFieldCount <= 32, "presence bits are a uint32_t");           \
+    [[nodiscard]] bool has(Field field) const { return present & schema::Bit(field); } \
+    static constexpr std::string_view Key(Field field) {                        \
+        return kFields[static_cast<size_t>(field)].key;                         \
+    }                                                                           \
+    template <typename Read>                                                    \
+    bool SetField(std::string_view name, Read&& read) {                         \
+        switch (schema::Hash(name)) {                                           \
+            FIELDS(SCHEMA_DECODE_CASE)                                          \
+        default: return false;                                                  \
+        }                                                                       \
+    }                                                                           \
+    template <typename Read>                                                    \
+    bool SetFieldAt(uint32_t index, Read&& read) {                              \
+        switch (index) {                                                        \
+            FIELDS(SCHEMA_DECODE_INDEX)                                         \
+        default: return false;                                                  \
+        }                                                                       \
+    }                                                                           \
+    template <typename Visitor>                                                 \
+    void ForEach(Visitor&& visitor) const { FIELDS(SCHEMA_VISIT) }
+
+namespace schema {
+
+    // ---------------------------------------------------------------- JSON in
+
+    template <Message T> void FromJson(const nlohmann::json& j, T& out);
+
+    template <typename V>
+    bool ReadJson(const nlohmann::json& j, V& out) {
+        if constexpr (std::is_same_v<V, bool>) {
+            if (!j.is_boolean()) return false;
+            out = j.get<bool>();
+        } else if constexpr (std::is_enum_v<V>) {
+            if (!j.is_number_integer()) return false;
+            out = static_cast<V>(j.get<std::underlying_type_t<V>>());
+        } else if constexpr (std::is_arithmetic_v<V>) {
+            if (!j.is_number()) return false;
+            out = j.get<V>();
+        } else if constexpr (std::is_same_v<V, std::string_view>) {
+            // Points into the parsed document; valid while it is alive
+            if (!j.is_string()) return false;
+            out = j.get_ref<const std::string&>();
+        } else if constexpr (std::is_same_v<V, std::string>) {
+            if (!j.is_string()) return false;
+            out = j.get_ref<const std::string&>();
+        } else if constexpr (Message<V>) {
+            if (!j.is_object()) return false;
+            FromJson(j, out);
+        } else {
+            return false;
+        }
+        return true;
+    }
+
+    // Fields with a missing or mistyped value are left at their defaults and
+    // not marked present.
+    template <Message T>
+    void FromJson(const nlohmann::json& j, T& out) {
+        if (!j.is_object()) return;
+        for (auto it = j.begin(); it != j.end(); ++it) {
+            out.SetField(it.key(), [&](auto& member) { return ReadJson(it.value(), member); });
+        }
+    }
+
+    // --------------------------------------------------------------- JSON out
+
+    inline void AppendJsonString(std::string& out, std::string_view str) {
+        out.push_back('"');
+        for (char c : str) {
+            switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char buf[8];
+                    std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+                    out += buf;
+                } else {
+                    out.push_back(c);
+                }
+            }
+        }
+        out.push_back('"');
+    }
+
+    template <Message T> void AppendJson(std::string& out, const T& message);
+
+    template <typename V>
+    void AppendJsonValue(std::string& out, const V& value) {
+        if constexpr (std::is_same_v<V, bool>) {
+            out += value ? "true" : "false";
+        } else if constexpr (std::is_enum_v<V>) {
+            AppendJsonValue(out, static_cast<std::underlying_type_t<V>>(value));
+        } else if constexpr (std::is_arithmetic_v<V>) {
+            char buf[32];
+            auto [end, ec] = std::to_chars(buf, buf + sizeof(buf), value);
+            out.append(buf, ec == std::errc() ? end : buf);
+        } else if constexpr (std::is_convertible_v<V, std::string_view>) {
+            AppendJsonString(out, value);
+        } else if constexpr (Message<V>) {
+            AppendJson(out, value);
+        } else {
+            static_assert(!sizeof(V), "no JSON encoding for this field type");
+        }
+    }
+
+    // Writes the message as a JSON object straight to text, keys in schema order.
+    template <Message T>
+    void AppendJson(std::string& out, const T& message) {
+        out.push_back('{');
+        bool first = true;
+        message.ForEach([&](std::string_view key, const auto& member) {
+            if (!first) out.push_back(',');
+            first = false;
+            AppendJsonString(out, key);
+            out.push_back(':');
+            AppendJsonValue(out, member);
+        });
+        out.push_back('}');
+    }
+
+    template <Message T>
+    std::string ToJsonString(const T& message) {
+        std::string out;
+        AppendJson(out, message);
+        return out;
+    }
+
+    // ------------------------------------------------------------ msgpack out
+
+    template <typename Buffer>
+    void PackKey(msgpack::packer<Buffer>& pk, std::string_view key) {
+        pk.pack_str(static_cast<uint32_t>(key.size()));
+        pk.pack_str_body(key.data(), static_cast<uint32_t>(key.size()));
+    }
+
+    template <typename Buffer, Message T> void PackMap(msgpack::packer<Buffer>& pk, const T& message);
+
+    template <typename Buffer, typename V>
+    void PackValue(msgpack::packer<Buffer>& pk, const V& value) {
+        if constexpr (std::is_enum_v<V>) {
+            pk.pack(static_cast<std::underlying_type_t<V>>(value));
+        } else if constexpr (std::is_arithmetic_v<V>) {
+            pk.pack(value);
+        } else if constexpr (std::is_convertible_v<V, std::string_view>) {
+            PackKey(pk, value);
+        } else if constexpr (Message<V>) {
+            PackMap(pk, value);
+        } else {
+            static_assert(!sizeof(V), "no msgpack encoding for this field type");
+        }
+    }
+
+    // {key: value, ...} in schema order
+    template <typename Buffer, Message T>
+    void PackMap(msgpack::packer<Buffer>& pk, const T& message) {
+        pk.pack_map(static_cast<uint32_t>(T::kFieldCount));
+        message.ForEach([&](std::string_view key, const auto& member) {
+            PackKey(pk, key);
+            PackValue(pk, member);
+        });
+    }
+
+    // [value, ...] in schema order; the schema is the only record of positions
+    template <typename Buffer, Message T>
+    void PackArray(msgpack::packer<Buffer>& pk, const T& message) {
+        pk.pack_array(static_cast<uint32_t>(T::kFieldCount));
+        message.ForEach([&](std::string_view, const auto& member) { PackValue(pk, member); });
+    }
+
+    // ------------------------------------------------------------- msgpack in
+
+    template <Message T> void FromMsgPackMap(const msgpack::object& obj, T& out);
+
+    template <typename V>
+    bool ReadMsgPack(const msgpack::object& obj, V& out) {
+        if constexpr (std::is_same_v<V, bool>) {
+            if (obj.type != msgpack::type::BOOLEAN) return false;
+            out = obj.via.boolean;
+        } else if constexpr (std::is_enum_v<V>) {
+            std::underlying_type_t<V> raw{};
+            if (!ReadMsgPack(obj, raw)) return false;
+            out = static_cast<V>(raw);
+        } else if constexpr (std::is_arithmetic_v<V>) {
+            switch (obj.type) {
+            case msgpack::type::POSITIVE_INTEGER: out = static_cast<V>(obj.via.u64); break;
+            case msgpack::type::NEGATIVE_INTEGER: out = static_cast<V>(obj.via.i64); break;
+            case msgpack::type::FLOAT32:
+            case msgpack::type::FLOAT64: out = static_cast<V>(obj.via.f64); break;
+            default: return false;
+            }
+        } else if constexpr (std::is_same_v<V, std::string_view> || std::is_same_v<V, std::string>) {
+            // string_view points into the unpacked zone; valid while it is alive
+            if (obj.type != msgpack::type::STR) return false;
+            out = V(obj.via.str.ptr, obj.via.str.size);
+        } else if constexpr (Message<V>) {
+            if (obj.type != msgpack::type::MAP) return false;
+            FromMsgPackMap(obj, out);
+        } else {
+            return false;
+        }
+        return true;
+    }
+
+    template <Message T>
+    void FromMsgPackMap(const msgpack::object& obj, T& out) {
+        if (obj.type != msgpack::type::MAP) return;
+        for (uint32_t i = 0; i < obj.via.map.size; i++) {
+            const auto& kv = obj.via.map.ptr[i];
+            if (kv.key.type != msgpack::type::STR) continue;
+            std::string_view key(kv.key.via.str.ptr, kv.key.via.str.size);
+            out.SetField(key, [&](auto& member) { return ReadMsgPack(kv.val, member); });
+        }
+    }
+
+    template <Message T>
+    void FromMsgPackArray(const msgpack::object& obj, T& out) {
+        if (obj.type != msgpack::type::ARRAY) return;
+        for (uint32_t i = 0; i < obj.via.array.size; i++) {
+            out.SetFieldAt(i, [&](auto& member) { return ReadMsgPack(obj.via.array.ptr[i], member); });
+        }
+    }
+}
+
+#endif
@@ -1,44 +1,65 @@
 #include "server_worker.h"
+#include "config.h"
 #include "profiler.h"
+#include "simulation.h"
+#include "thread_affinity.h"
+#include "tick_scheduler.h"
+#include "degradation.h"
+#include "cpu_profiler.h"
 
 using json = nlohmann::json;
 
-ServerWorker::ServerWorker() {}
+ServerWorker::ServerWorker(int index, Simulation *simulation) : index_(index), simulation_(simulation) {}
+
+// Index of the worker running on this thread, for callbacks without a
+// ServerWorker (uWS preOpen, us_timer handlers).
+static thread_local int current_worker = -1;
 
 // Sends a pong response for a "ping" message.
-void ServerWorker::handlePing(auto *ws, const json &message, uWS::OpCode opCode) {
+void ServerWorker::handlePing(auto *ws, const ClientMessage &message, uWS::OpCode opCode) {
     PROFILE_SCOPE("handlePing");
-    long long clientTime = message.value("clientTime", 0LL);
     auto now = std::chrono::system_clock::now();
-    auto serverTime = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count();
 
-    json pongMsg = {
-        {"messageType", "pong"},
-        {"serverTime", serverTime},
-        {"clientTime", clientTime}
-    };
+    PongMessage pong;
+    pong.message_type = "pong";
+    pong.server_time = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count();
+    pong.client_time = message.client_time;
 
-    ws->send(pongMsg.dump(), opCode);
+    std::string reply = schema::ToJsonString(pong);
+    ws->send(reply, opCode);
+    ws->getUserData()->bytes_out += reply.size();
+    ws->getUserData()->messages_out++;
 }
 
 // Processes a "join" message.
-void ServerWorker::handleJoin(auto * /*ws*/, const json &message, const std::shared_ptr<Player>& player_ptr) {
+void ServerWorker::handleJoin(PointerToPlayer &client, const ClientMessage &message) {
     PROFILE_SCOPE("handleJoin");
+    using Field = ClientMessage::Field;
+    // Other workers read a player's id and username once it is in the grid,
+    // so a re-join replaces the player instead of renaming it in place
+    if (client.joined) {
+        grid->Remove(client.player);
+        client.player = std::make_shared<Player>();
+        client.player->set_type("player");
+        client.joined = false;
+    }
+    const auto& player_ptr = client.player;
+    // Clients opt into the bit-packed snapshot format at join time.
+    client.packed_snapshots = message.snapshot_codec == "packed";
+
     // Set the player's ID and attributes using default values if keys are missing.
-    player_ptr->set_id(message.value("id", "unknown"));
-    player_ptr->set_username(message.value("username", "unknown"));
+    player_ptr->set_id(std::string(message.has(Field::id) ? message.id : "unknown"));
+    player_ptr->set_username(std::string(message.has(Field::username) ? message.username : "unknown"));
 
     double x = 0.0, y = 0.0;
-    int health = message.value("health", 100);
-    double size = message.value("size", 20.0);
-    long long time_update = message.value("timeUpdate", 0LL);
+    int health = message.has(Field::health) ? message.health : 100;
+    double size = message.has(Field::size) ? message.size : 20.0;
+    long long time_update = message.time_update;
 
     // Extract position if provided.
-    if (message.contains("position") &&
-        message["position"].contains("x") &&
-        message["position"].contains("y")) {
-        x = message["position"]["x"].get<double>();
-        y = message["position"]["y"].get<double>();
+    if (message.position.complete()) {
+        x = message.position.x;
+        y = message.position.y;
     }
 
     if (x < 0 || y < 0 || x > grid->get_width() || y > grid->get_height()) {
@@ -54,24 +75,25 @@ void ServerWorker::handleJoin(auto * /*ws*/, const json &message, const std::sha
 
     // Insert the player into the grid.
     grid->Insert(player_ptr);
+    client.joined = true;
 }
 
 // Processes a "movement" message.
-void ServerWorker::handleMovement(auto * /*ws*/, const json &message, const std::shared_ptr<Player>& player_ptr) {
+void ServerWorker::handleMovement(PointerToPlayer &client, const ClientMessage &message) {
     PROFILE_SCOPE("handleMovement");
-    if (!message.contains("objectType")) return;
-    if (message["objectType"] == "player") {
+    using Field = ClientMessage::Field;
+    const auto& player_ptr = client.player;
+    if (!message.has(Field::object_type)) return;
+    if (message.object_type == "player") {
         // Handle player movement.
-        long long time_update = message.value("timeUpdate", 0LL);
+        long long time_update = message.time_update;
         
         double new_x = player_ptr->get_x();
         double new_y = player_ptr->get_y();
 
-        if (message.contains("position") &&
-            message["position"].contains("x") &&
-            message["position"].contains("y")) {
-            new_x = message["position"]["x"].get<double>();
-            new_y = message["position"]["y"].get<double>();
+        if (message.position.complete()) {
+            new_x = message.position.x;
+            new_y = message.position.y;
         }
 
         player_ptr->set_x(new_x);
@@ -80,40 +102,35 @@ void ServerWorker::handleMovement(auto * /*ws*/, const json &message, const std:
 
         grid->Update(player_ptr, 0);
 
-    } else if (message["objectType"] == "snowball") {
+    } else if (message.object_type == "snowball") {
         // Handle snowball movement.
-        std::string snowball_id = message.value("id", "unknown");
+        std::string snowball_id(message.has(Field::id) ? message.id : "unknown");
         bool is_new = false;
         std::shared_ptr<Snowball> snowball_ptr;
 
         if (!thread_objects.count(snowball_id)) {
             snowball_ptr = std::make_shared<Snowball>(snowball_id, "snowball");
+            snowball_ptr->set_owner(current_worker);
             thread_objects[snowball_id] = snowball_ptr;
             is_new = true;
         } else {
             snowball_ptr = std::static_pointer_cast<Snowball>(thread_objects[snowball_id]);
         }
 
-        // std::cout << "thread_object's size: " << thread_objects_.size() << std::endl;
-
         double x = 0.0, y = 0.0, vx = 0.0, vy = 0.0;
-        double size = message.value("size", 1.0);
-        long long time_update = message.value("timeUpdate", 0LL);
-        long long life_length = message.value("lifeLength", static_cast<long long>(4e18));
-        int damage = message.value("damage", 0);
-        bool charging = message.value("charging", false);
-
-        if (message.contains("position") &&
-            message["position"].contains("x") &&
-            message["position"].contains("y")) {
-            x = message["position"]["x"].get<double>();
-            y = message["position"]["y"].get<double>();
+        double size = message.has(Field::size) ? message.size : 1.0;
+        long long time_update = message.time_update;
+        long long life_length = message.has(Field::life_length) ? message.life_length : static_cast<long long>(4e18);
+        int damage = message.damage;
+        bool charging = message.charging;
+
+        if (message.position.complete()) {
+            x = message.position.x;
+            y = message.position.y;
         }
-        if (message.contains("velocity") &&
-            message["velocity"].contains("x") &&
-            message["velocity"].contains("y")) {
-            vx = message["velocity"]["x"].get<double>();
-            vy = message["velocity"]["y"].get<double>();
+        if (message.velocity.complete()) {
+            vx = message.velocity.x;
+            vy = message.velocity.y;
         }
 
         snowball_ptr->set_x(x);
@@ -138,25 +155,36 @@ void ServerWorker::handleMovement(auto * /*ws*/, const json &message, const std:
 void ServerWorker::HandleMessage(auto *ws, std::string_view str_message, uWS::OpCode opCode) {
     PROFILE_FUNCTION();
     SystemMonitor::instance().increment_msg_processed();
-    
-    // Fast path: check for ping without full JSON parse
-    if (str_message.find("\"ping\"") != std::string_view::npos) {
-        json message = json::parse(str_message);
+
+    // One parse, then a single pass over the keys into the typed message.
+    // String fields view into `document`, so it must outlive `message`.
+    json document = json::parse(str_message, nullptr, false);
+    if (document.is_discarded()) return;
+    ClientMessage message;
+    schema::FromJson(document, message);
+
+    if (message.type == "ping") {
         handlePing(ws, message, opCode);
         return;
     }
-    
-    json message = json::parse(str_message);
-    std::string type = message.value("type", "");
 
-    // Retrieve the player's pointer from user data.
-    auto player_ptr = ws->getUserData()->player;
+    // Simulation mode: the I/O thread stops at decoding and hands the
+    // command over; the document travels with it to keep the views valid.
+    if (simulation_) {
+        Command command;
+        command.kind = Command::Kind::kMessage;
+        command.client = ws->getUserData()->client_id;
+        command.document = std::move(document);
+        command.message = message;
+        simulation_->Push(std::move(command));
+        return;
+    }
 
-    if (type == "join") {
-        handleJoin(ws, message, player_ptr);
+    if (message.type == "join") {
+        handleJoin(*ws->getUserData(), message);
     }
-    else if (type == "movement") {
-        handleMovement(ws, message, player_ptr);
+    else if (message.type == "movement") {
+        handleMovement(*ws->getUserData(), message);
     }
 }
 
@@ -165,8 +193,82 @@ void ServerWorker::HandleMessage(auto *ws, std::string_view str_message, uWS::Op
 // Adjust these as needed for your application.
 //
 
-void ServerWorker::Start(int port) {
-    worker_thread_ = std::thread(&ServerWorker::StartServer, this, port);
+void ServerWorker::Start(int port, int cpu) {
+    if (simulation_) {
+        simulation_->AddWorker(index_, [this] { WakeForOutbound(); });
+    }
+    worker_thread_ = std::thread(&ServerWorker::StartServer, this, port, cpu);
+}
+
+// Pins the calling thread before it allocates anything, so the loop, its
+// sockets and the game objects it creates land on the CPU's NUMA node.
+void PlaceCurrentThread(const char *name, int cpu) {
+    if (cpu < 0) return;
+    bool pinned = thread_affinity::PinCurrentThread(cpu);
+    bool local = pinned && thread_affinity::UseLocalMemoryPolicy();
+    std::unique_lock<std::shared_mutex> lock(output_mtx);
+    if (!pinned) {
+        std::cerr << name << ": could not pin to CPU " << cpu << ", leaving it unpinned" << std::endl;
+        return;
+    }
+    std::cout << name << " pinned to CPU " << cpu;
+    int node = thread_affinity::NodeOfCpu(cpu);
+    if (node >= 0) std::cout << " (NUMA node " << node << (local ? ", local allocation" : "") << ")";
+    std::cout << std::endl;
+}
+
+void OpenTickLog(TickLog& log, const std::string& thread_name) {
+    if (server_config.tick_log_dir.empty()) return;
+    std::string path = server_config.tick_log_dir + "/ticks-" + thread_name + ".bin";
+    uint64_t capacity = static_cast<uint64_t>(server_config.tick_rate) * constants::TICK_LOG_SECONDS;
+    bool opened = log.Open(path, capacity);
+    std::unique_lock<std::shared_mutex> lock(output_mtx);
+    if (opened) std::cout << "Tick log: " << path << std::endl;
+    else std::cerr << "Could not create tick log " << path << ": " << std::strerror(errno) << std::endl;
+}
+
+// Timer callback: publishes this worker's per-connection stats and pings
+// every client without an unanswered ping (the pong handler times it).
+static void PublishConnectionStats(struct us_timer_t * /*t*/) {
+    PROFILE_SCOPE("PublishConnectionStats");
+    auto now = std::chrono::steady_clock::now();
+    std::vector<ConnectionStats> stats;
+    stats.reserve(thread_clients.size());
+    thread_clients.ForEach([&](ClientSocket *ws) {
+        auto *user_data = ws->getUserData();
+        ConnectionStats s;
+        s.client_id = user_data->client_id;
+        s.worker = current_worker;
+        s.connected_s = std::chrono::duration_cast<std::chrono::seconds>(now - user_data->connected_at).count();
+        s.bytes_in = user_data->bytes_in;
+        s.messages_in = user_data->messages_in;
+        s.bytes_out = user_data->bytes_out;
+        s.messages_out = user_data->messages_out;
+        s.rtt_us = user_data->rtt_us;
+        s.buffered_bytes = ws->getBufferedAmount();
+        s.dropped_snapshots = user_data->dropped_snapshots;
+        s.backpressured = user_data->backpressured;
+        if (user_data->ping_sent == std::chrono::steady_clock::time_point{}) {
+            user_data->ping_sent = now;
+            ws->send({}, uWS::OpCode::PING);
+        } else {
+            // A client that stopped answering shows up as slow, not as its last good RTT
+            s.rtt_us = std::max(s.rtt_us, static_cast<long long>(
+                std::chrono::duration_cast<std::chrono::microseconds>(now - user_data->ping_sent).count()));
+        }
+        stats.push_back(s);
+    });
+    connection_stats->Publish(current_worker, std::move(stats));
+    // Same period: sockets that never upgraded stop counting as balancer load
+    if (balancer) balancer->ExpireUnopened(current_worker);
+}
+
+// Called from the simulation thread after a tick queued frames for this worker.
+void ServerWorker::WakeForOutbound() {
+    uWS::Loop *loop = loop_.load(std::memory_order_acquire);
+    if (loop) {
+        loop->defer([this] { DrainOutbound(); });
+    }
 }
 
 std::string ExtractPlayerId(const std::string& snowballId) {
@@ -180,108 +282,287 @@ std::string ExtractPlayerId(const std::string& snowballId) {
     return snowballId.substr(firstUnderscore + 1, secondUnderscore - firstUnderscore - 1);
 }
 
-void UpdatePlayerView(auto *ws, auto player_ptr) {
-    PROFILE_SCOPE("UpdatePlayerView");
+// Kills an object on its owner's thread: here if this thread owns it,
+// otherwise through the owner's mailbox.
+static void KillObject(const std::shared_ptr<GameObject>& obj, long long current_time) {
+    int owner = obj->get_owner();
+    if (owner < 0 || owner == current_worker || !mailboxes) {
+        obj->Kill(current_time);
+        return;
+    }
+    mailboxes->Post(owner, WorkerEvent{WorkerEvent::Kind::kKill, obj, current_time});
+    SystemMonitor::instance().increment_cross_worker_events();
+}
+
+// A damaging object thrown by someone else that overlaps a living player; kills it.
+static bool HitsPlayer(const std::shared_ptr<GameObject>& obj, const std::shared_ptr<Player>& player_ptr,
+                       long long current_time) {
+    if (player_ptr->get_is_dead() || !obj->get_damage() ||
+        ExtractPlayerId(obj->get_id()) == player_ptr->get_id() || !obj->Collide(player_ptr)) {
+        return false;
+    }
+    KillObject(obj, current_time);
+    return true;
+}
+
+void CheckPlayerCollisions(PointerToPlayer &client, long long current_time) {
+    PROFILE_SCOPE("CheckPlayerCollisions");
+    const auto& player_ptr = client.player;
+    // One cell of reach covers any snowball that can overlap the player
+    double reach = player_ptr->get_size() + grid->get_cell_size();
+    auto nearby = grid->Search(player_ptr->get_y() - reach, player_ptr->get_y() + reach,
+                               player_ptr->get_x() - reach, player_ptr->get_x() + reach);
+    for (const auto& obj : nearby) {
+        if (obj != player_ptr && HitsPlayer(obj, player_ptr, current_time)) {
+            client.pending_events.push_back(player_ptr->Hurt(obj->get_damage(), current_time));
+        }
+    }
+}
 
-    double lower_y = player_ptr->get_y() - (constants::FIXED_VIEW_HEIGHT);
-    double upper_y = lower_y + 2 * constants::FIXED_VIEW_HEIGHT;
-    double left_x = player_ptr->get_x() - (constants::FIXED_VIEW_WIDTH);
-    double right_x = left_x + 2 * constants::FIXED_VIEW_WIDTH;
+std::string_view BuildPlayerView(PointerToPlayer &client, long long current_time, double view_scale, bool check_hits) {
+    PROFILE_SCOPE("UpdatePlayerView");
+    const auto& player_ptr = client.player;
+
+    double half_height = constants::FIXED_VIEW_HEIGHT * view_scale;
+    double half_width = constants::FIXED_VIEW_WIDTH * view_scale;
+    double lower_y = player_ptr->get_y() - half_height;
+    double upper_y = lower_y + 2 * half_height;
+    double left_x = player_ptr->get_x() - half_width;
+    double right_x = left_x + 2 * half_width;
     
     // Get neighbors - use auto to allow move semantics/RVO
     auto neighbors = grid->Search(lower_y, upper_y, left_x, right_x);
     
-    // Build batch message with MessagePack
-    auto now = std::chrono::system_clock::now();
-    long long current_time = std::chrono::duration_cast<std::chrono::milliseconds>(
-        now.time_since_epoch()).count();
+    auto *user_data = &client;
+    
+    // First pass: collect valid objects and handle collisions
+    std::vector<std::shared_ptr<GameObject>> valid_objects;
+    valid_objects.reserve(neighbors.size()); // Reserve to avoid reallocation
+    for (auto obj : neighbors) {
+        // Skip the player themselves
+        if (obj->get_id() == player_ptr->get_id()) {
+            continue;
+        }
+        
+        // Skip dead objects that expired (beyond grace period for death notification)
+        // Allow recently dead objects to be sent so clients can see death state
+        if (obj->get_is_dead() && obj->Expired(current_time)) {
+            continue;
+        }
+        
+        // Handle collision with damaging objects
+        if (check_hits && HitsPlayer(obj, player_ptr, current_time)) {
+            user_data->pending_events.push_back(player_ptr->Hurt(obj->get_damage(), current_time));
+            // Don't send this object (it just collided)
+        } else {
+            valid_objects.push_back(obj);
+        }
+    }
+    
+    std::string_view frame;
+
+    // Distance-based update rates within a per-frame byte budget
+    InterestSet::UpdateBudget budget;
+    budget.viewer_x = player_ptr->get_x();
+    budget.viewer_y = player_ptr->get_y();
+    budget.current_time = current_time;
+    budget.max_bytes = server_config.snapshot_budget;
+    if (user_data->packed_snapshots) {
+        budget.spawn_bytes = snapshot_codec::kApproxSpawnBytes;
+        budget.update_bytes = snapshot_codec::kApproxUpdateBytes;
+    } else {
+        budget.spawn_bytes = InterestSet::kMsgPackSpawnBytes;
+        budget.update_bytes = InterestSet::kMsgPackUpdateBytes;
+    }
+    const InterestSet::UpdateBudget *budget_ptr = server_config.snapshot_rates ? &budget : nullptr;
     
-    // Use thread_local buffer to avoid repeated allocations
+    // Use thread_local buffers to avoid repeated allocations
     thread_local msgpack::sbuffer buffer;
-    buffer.clear(); // Reuse the buffer
-    msgpack::packer<msgpack::sbuffer> pk(&buffer);
+    thread_local BitWriter bit_writer;
     
-    {
+    if (user_data->packed_snapshots) {
+        PROFILE_SCOPE("UpdatePlayerView_BuildPacked");
+        user_data->interest.Update(valid_objects, budget_ptr);
+        snapshot_codec::Encode(bit_writer, user_data->interest, user_data->pending_events,
+                               player_ptr->get_x(), player_ptr->get_y(), current_time);
+        frame = std::string_view(reinterpret_cast<const char *>(bit_writer.data()), bit_writer.size());
+    } else {
         PROFILE_SCOPE("UpdatePlayerView_BuildMsgPack");
+        buffer.clear(); // Reuse the buffer
+        msgpack::packer<msgpack::sbuffer> pk(&buffer);
         
-        // Pack batch message as map: {messageType: "batch_update", timestamp: xxx, updates: [...]}
-        pk.pack_map(3);
+        // Pack batch message as map:
+        // {messageType: "batch_update", timestamp: xxx, spawns: [...], updates: [...], despawns: [...], events: [...]}
+        using Field = BatchUpdate::Field;
+        pk.pack_map(BatchUpdate::kFieldCount);
         
-        pk.pack("messageType");
+        schema::PackKey(pk, BatchUpdate::Key(Field::message_type));
         pk.pack("batch_update");
         
-        pk.pack("timestamp");
+        schema::PackKey(pk, BatchUpdate::Key(Field::timestamp));
         pk.pack(current_time);
         
-        pk.pack("updates");
+        // Second pass: diff against what the client already knows and pack
+        user_data->interest.PackDelta(pk, valid_objects, current_time, budget_ptr);
         
-        // First pass: collect valid objects and handle collisions
-        std::vector<std::shared_ptr<GameObject>> valid_objects;
-        valid_objects.reserve(neighbors.size()); // Reserve to avoid reallocation
-        for (auto obj : neighbors) {
-            // Skip the player themselves
-            if (obj->get_id() == player_ptr->get_id()) {
-                continue;
-            }
-            
-            // Skip dead objects that expired (beyond grace period for death notification)
-            // Allow recently dead objects to be sent so clients can see death state
-            if (obj->get_is_dead() && obj->Expired(current_time)) {
-                continue;
-            }
-            
-            // Handle collision with damaging objects
-            if (obj->get_damage() && ExtractPlayerId(obj->get_id()) != player_ptr->get_id() && obj->Collide(player_ptr)) {
-                player_ptr->Hurt(ws, obj->get_damage());
-                // Don't send this object (it just collided)
-            } else {
-                valid_objects.push_back(obj);
-            }
-        }
-        
-        // Pack array of updates with correct count
-        pk.pack_array(valid_objects.size());
-        
-        // Second pass: pack all valid objects
-        for (auto obj : valid_objects) {
-            obj->ToMsgPack(pk, current_time);
+        // Hits and deaths ride along in the same frame
+        schema::PackKey(pk, BatchUpdate::Key(Field::events));
+        pk.pack_array(user_data->pending_events.size());
+        for (const auto& event : user_data->pending_events) {
+            schema::PackArray(pk, event);
         }
+        frame = std::string_view(buffer.data(), buffer.size());
     }
     
-    // Send binary message
-    if (buffer.size() > 0) {
-        PROFILE_SCOPE("UpdatePlayerView_WebSocketSend");
-        ws->send(std::string_view(buffer.data(), buffer.size()), uWS::OpCode::BINARY);
-        SystemMonitor::instance().increment_msg_sent();
+    user_data->pending_events.clear();
+    return frame;
+}
+
+void BuildPlayerViews(const std::vector<PointerToPlayer*>& clients, long long current_time, double view_scale,
+                      std::vector<std::string>& frames) {
+    PROFILE_SCOPE("BuildPlayerViews");
+    // Hits kill snowballs other clients may see; do them all before any build
+    for (auto *client : clients) {
+        CheckPlayerCollisions(*client, current_time);
     }
+    frames.resize(clients.size());
+    constexpr size_t kClientsPerTask = 4;
+    // Grid searches on pool threads count toward this thread's tick; chunks
+    // the caller runs itself are already on its own counters
+    ThreadCounters *caller = &thread_counters();
+    std::atomic<uint64_t> pool_grid_ops{0}, pool_lock_wait_ns{0};
+    view_pool->ParallelFor(clients.size(), kClientsPerTask, [&](size_t begin, size_t end) {
+        ThreadCounters& counters = thread_counters();
+        ThreadCounters before = counters;
+        for (size_t i = begin; i < end; i++) {
+            std::string_view frame = BuildPlayerView(*clients[i], current_time, view_scale, false);
+            frames[i].assign(frame.data(), frame.size());  // Out of this thread's buffers
+        }
+        if (&counters != caller) {
+            pool_grid_ops.fetch_add(counters.grid_ops - before.grid_ops, std::memory_order_relaxed);
+            pool_lock_wait_ns.fetch_add(counters.lock_wait_ns - before.lock_wait_ns, std::memory_order_relaxed);
+        }
+    });
+    caller->grid_ops += pool_grid_ops.load(std::memory_order_relaxed);
+    caller->lock_wait_ns += pool_lock_wait_ns.load(std::memory_order_relaxed);
 }
 
-void HandleThreadClients(struct us_timer_t * /*t*/) {
-    PROFILE_SCOPE("HandleThreadClients");
-    auto clients_copy = thread_clients;
-    auto now = std::chrono::system_clock::now();
-    auto current_time = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count();
+// Sends a finished batch_update; deflate only pays off on large frames.
+// Returns false if the socket was closed instead: its close handler has
+// already run, so the caller must not touch ws (or its user data) again.
+[[nodiscard]] static bool SendFrame(auto *ws, std::string_view frame) {
+    PROFILE_SCOPE("UpdatePlayerView_WebSocketSend");
+    bool compress = server_config.compression != ServerConfig::Compression::kOff &&
+                    frame.size() >= server_config.compression_threshold;
+    if (ws->send(frame, uWS::OpCode::BINARY, compress) == std::remove_pointer_t<decltype(ws)>::DROPPED) {
+        // uWS refused the frame, so the client's interest set no longer
+        // matches what it was told; a reconnect starts it over
+        ws->end(1013, "Too slow");
+        return false;
+    }
+    SystemMonitor::instance().increment_msg_sent();
+    SystemMonitor::instance().add_bytes_sent(frame.size());
+    ws->getUserData()->bytes_out += frame.size();
+    ws->getUserData()->messages_out++;
+    return true;
+}
 
-    for (auto *ws : clients_copy) {
-        auto player_ptr = ws->getUserData()->player;
-        if (player_ptr->get_is_dead()) {
-            thread_clients.erase(ws);
+// Flags the socket once more than --backpressure-limit bytes are queued on it.
+// Returns true if it just became backpressured. Every frame already queued is
+// still delivered (the interest set was advanced for it); what stops is
+// building new ones, so the first snapshot after the drain is a coalesced
+// delta carrying only the newest state.
+static bool MarkBackpressured(auto *ws) {
+    auto *user_data = ws->getUserData();
+    if (user_data->backpressured || ws->getBufferedAmount() <= server_config.backpressure_limit) {
+        return false;
+    }
+    user_data->backpressured = true;
+    SystemMonitor::instance().client_backpressured(true);
+    return true;
+}
+
+void UpdatePlayerView(auto *ws, long long current_time, double view_scale) {
+    std::string_view frame = BuildPlayerView(*ws->getUserData(), current_time, view_scale);
+    if (frame.size() > 0) {
+        (void)SendFrame(ws, frame);
+    }
+}
+
+static thread_local DegradationController thread_degradation;
+
+// Grid cell of the client's player in row-major order, for ClientRegistry::SortBy.
+static long long ClientCell(ClientSocket *ws) {
+    const auto& player_ptr = ws->getUserData()->player;
+    int cell_size = grid->get_cell_size();
+    long long cols = grid->get_width() / cell_size + 1;
+    return static_cast<long long>(player_ptr->get_y() / cell_size) * cols +
+           static_cast<long long>(player_ptr->get_x() / cell_size);
+}
+
+void UpdateThreadClients(long long tick, long long current_time) {
+    PROFILE_SCOPE("HandleThreadClients");
+    size_t shed = 0;
+    size_t dropped = 0;
+    // With a view pool, clients due a snapshot are built together after the pass
+    static thread_local std::vector<ClientSocket*> batch;
+    static thread_local std::vector<PointerToPlayer*> batch_clients;
+    static thread_local std::vector<std::string> batch_frames;
+    batch.clear();
+
+    thread_clients.ForEach([&](ClientSocket *ws) {
+        auto *user_data = ws->getUserData();
+        const auto& player_ptr = user_data->player;
+        // Dead players stop receiving views once a frame has carried their
+        // death; the socket stays registered (for its connection stats) until
+        // it closes
+        bool dying = player_ptr->get_is_dead();
+        if (dying && user_data->pending_events.empty()) {
             return;
         }
-        if (player_ptr->Expired(current_time)) {
+        MarkBackpressured(ws);
+        if (!dying && player_ptr->Expired(current_time)) {
             grid->Remove(player_ptr);
+            return;
+        }
+        if (user_data->backpressured) {
+            // A death waits in pending_events until the drain handler clears this
+            CheckPlayerCollisions(*user_data, current_time);
+            user_data->dropped_snapshots++;
+            dropped++;
+            return;
+        }
+        if (!dying && !thread_degradation.ShouldSend(tick, user_data->client_id,
+                                                     player_ptr->get_time_update(), current_time)) {
+            CheckPlayerCollisions(*user_data, current_time);
+            // Shedding never holds back a death: the killing tick sends it
+            if (!player_ptr->get_is_dead()) {
+                shed++;
+                return;
+            }
+        }
+        if (view_pool) {
+            batch.push_back(ws);
         } else {
-            UpdatePlayerView(ws, player_ptr);
+            UpdatePlayerView(ws, current_time, thread_degradation.view_scale());
+        }
+    });
+
+    if (!batch.empty()) {
+        batch_clients.clear();
+        for (auto *ws : batch) batch_clients.push_back(ws->getUserData());
+        BuildPlayerViews(batch_clients, current_time, thread_degradation.view_scale(), batch_frames);
+        // Back on this loop's thread, the only one allowed to send on its sockets
+        for (size_t i = 0; i < batch.size(); i++) {
+            if (!batch_frames[i].empty()) (void)SendFrame(batch[i], batch_frames[i]);
         }
     }
+    if (shed) SystemMonitor::instance().add_snapshots_shed(shed);
+    if (dropped) SystemMonitor::instance().add_snapshots_dropped_backpressure(dropped);
 }
-void HandleThreadObjects(struct us_timer_t * /*t*/) {
+void UpdateThreadObjects(long long current_time) {
     PROFILE_SCOPE("HandleThreadObjects");
     
-    // Get current time once, outside the loop
-    auto now = std::chrono::system_clock::now();
-    auto current_time = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count();
-    
     // Update total objects count
     SystemMonitor::instance().set_total_objects(thread_objects.size());
     
@@ -313,28 +594,233 @@ void HandleThreadObjects(struct us_timer_t * /*t*/) {
     }
 }
 
-void ServerWorker::StartServer(int port) {
+static thread_local std::unique_ptr<TickScheduler> thread_scheduler;
+static thread_local TickLog thread_tick_log;
+
+static long long SinceUs(std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+}
+
+// Applies what other workers did to this worker's objects since the last tick.
+static void ApplyMailbox() {
+    if (!mailboxes) return;
+    mailboxes->Drain(current_worker, [](WorkerEvent& event) {
+        switch (event.kind) {
+        case WorkerEvent::Kind::kKill:
+            event.object->Kill(event.time);
+            break;
+        }
+    });
+}
+
+// Timer callback: runs every fixed-timestep tick that has come due on this
+// worker, then re-arms the timer for the next deadline.
+void HandleTick(struct us_timer_t *t) {
+    int object_every = thread_scheduler->TicksPer(constants::OBJECT_UPDATE_PERIOD_MS);
+    int sort_every = thread_scheduler->TicksPer(constants::CLIENT_SORT_PERIOD_MS);
+    thread_scheduler->RunDue([&](long long tick, long long current_time) {
+        PROFILE_SCOPE("Tick");
+        auto tick_wall = std::chrono::system_clock::now();
+        auto tick_start = std::chrono::steady_clock::now();
+        ApplyMailbox();
+        auto input_end = std::chrono::steady_clock::now();
+        if (tick % sort_every == 0) {
+            thread_clients.SortBy(ClientCell);
+        }
+        UpdateThreadClients(tick, current_time);
+        auto views_end = std::chrono::steady_clock::now();
+        if (tick % object_every == 0) {
+            UpdateThreadObjects(current_time);
+        }
+        auto tick_end = std::chrono::steady_clock::now();
+        long long tick_us = std::chrono::duration_cast<std::chrono::microseconds>(tick_end - tick_start).count();
+        if (thread_tick_log.is_open()) {
+            TickRecord record;
+            record.tick = static_cast<uint64_t>(tick);
+            record.unix_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                tick_wall.time_since_epoch()).count();
+            record.duration_us = static_cast<uint32_t>(tick_us);
+            record.input_us = static_cast<uint32_t>(SinceUs(tick_start, input_end));
+            record.views_us = static_cast<uint32_t>(SinceUs(input_end, views_end));
+            record.objects_us = static_cast<uint32_t>(SinceUs(views_end, tick_end));
+            record.clients = static_cast<uint32_t>(thread_clients.size());
+            record.objects = static_cast<uint32_t>(thread_objects.size());
+            record.degradation_level = static_cast<uint32_t>(thread_degradation.level());
+            thread_tick_log.Append(record);
+        }
+        if (balancer) {
+            balancer->RecordTick(current_worker, tick_us);
+        }
+        thread_degradation.Observe(tick_us,
+            std::chrono::duration_cast<std::chrono::microseconds>(thread_scheduler->interval()).count());
+        SystemMonitor::instance().set_degradation_level(current_worker, thread_degradation.level());
+        SystemMonitor::instance().record_thread_tick(current_worker, tick_us);
+    });
+    // The timer counts whole milliseconds: round up so it never fires before
+    // the deadline (at most 1 ms late, never a whole interval)
+    auto until = thread_scheduler->next_deadline() - std::chrono::steady_clock::now();
+    long long delay_ms = std::chrono::ceil<std::chrono::milliseconds>(until).count();
+    us_timer_set(t, HandleTick, static_cast<int>(std::max(1LL, delay_ms)), 0);
+}
+
+// Runs on this worker's loop thread (via Loop::defer) to send the frames the
+// simulation thread produced for its clients.
+void ServerWorker::DrainOutbound() {
+    PROFILE_SCOPE("DrainOutbound");
+    auto& queue = simulation_->outbound(index_);
+    OutboundFrame out;
+    [[maybe_unused]] auto now = std::chrono::steady_clock::now();
+    while (queue.TryPop(out)) {
+        PROFILE_RECORD("QUEUE_WAIT:outbound",
+            std::chrono::duration_cast<std::chrono::microseconds>(now - out.enqueued).count());
+        auto it = sockets_.find(out.client);
+        if (it == sockets_.end()) continue;  // Closed since the frame was built
+        // Frames built before the simulation heard about the backpressure
+        // still go out; telling it stops the next ones.
+        it->second->getUserData()->dropped_snapshots = out.dropped_snapshots;
+        // A refused frame closes the socket, which erases it from sockets_
+        if (!SendFrame(it->second, out.frame)) continue;
+        if (MarkBackpressured(it->second)) {
+            PushBackpressure(out.client, true);
+        }
+    }
+}
+
+// Tells the simulation thread to stop or resume building snapshots for a client.
+void ServerWorker::PushBackpressure(uint64_t client, bool backpressured) {
+    Command command;
+    command.kind = Command::Kind::kBackpressure;
+    command.client = client;
+    command.backpressured = backpressured;
+    simulation_->Push(std::move(command));
+}
+
+// Maps the configured permessage-deflate mode onto uWS compressor options.
+static uWS::CompressOptions CompressOptionsFor(const ServerConfig& config) {
+    switch (config.compression) {
+    case ServerConfig::Compression::kShared:
+        return uWS::CompressOptions(uWS::SHARED_COMPRESSOR | uWS::SHARED_DECOMPRESSOR);
+    case ServerConfig::Compression::kDedicated:
+        switch (config.compression_window_kb) {
+        case 3: return uWS::CompressOptions(uWS::DEDICATED_COMPRESSOR_3KB | uWS::SHARED_DECOMPRESSOR);
+        case 4: return uWS::CompressOptions(uWS::DEDICATED_COMPRESSOR_4KB | uWS::SHARED_DECOMPRESSOR);
+        case 8: return uWS::CompressOptions(uWS::DEDICATED_COMPRESSOR_8KB | uWS::SHARED_DECOMPRESSOR);
+        case 16: return uWS::CompressOptions(uWS::DEDICATED_COMPRESSOR_16KB | uWS::SHARED_DECOMPRESSOR);
+        case 64: return uWS::CompressOptions(uWS::DEDICATED_COMPRESSOR_64KB | uWS::SHARED_DECOMPRESSOR);
+        case 128: return uWS::CompressOptions(uWS::DEDICATED_COMPRESSOR_128KB | uWS::SHARED_DECOMPRESSOR);
+        case 256: return uWS::CompressOptions(uWS::DEDICATED_COMPRESSOR_256KB | uWS::SHARED_DECOMPRESSOR);
+        default: return uWS::CompressOptions(uWS::DEDICATED_COMPRESSOR_32KB | uWS::SHARED_DECOMPRESSOR);
+        }
+    default:
+        return uWS::DISABLED;
+    }
+}
+
+// preOpen hook: lets the balancer move a freshly accepted socket to a less
+// loaded worker before this loop creates a connection for it.
+static LIBUS_SOCKET_DESCRIPTOR RouteAcceptedSocket(struct us_socket_context_t * /*context*/, LIBUS_SOCKET_DESCRIPTOR fd) {
+    if (!balancer) return fd;
+    if (balancer->Route(current_worker, fd)) {
+        return (LIBUS_SOCKET_DESCRIPTOR) -1;  // Now owned by another loop
+    }
+    // Counts toward this worker's load from now on, not only once it upgrades
+    balancer->Kept(current_worker);
+    return fd;
+}
+
+// Records this worker's client count in the balancer and SystemMonitor.
+void ServerWorker::ClientCountChanged(int delta) {
+    client_count_ += delta;
+    if (balancer) {
+        if (delta > 0) balancer->ClientOpened(index_);
+        else balancer->ClientClosed(index_);
+    }
+    SystemMonitor::instance().set_worker_clients(index_, client_count_);
+}
+
+void ServerWorker::StartServer(int port, int cpu) {
+    PlaceCurrentThread("Worker", cpu);
+    current_worker = index_;
+    Tracer::instance().SetThreadName("Worker " + std::to_string(index_));
+    CpuProfiler::instance().RegisterThread("Worker " + std::to_string(index_));
+
     // Create an SSL app with required certificate and key file options.
     uWS::SSLApp sslApp = uWS::SSLApp({
         .key_file_name = "private/key.pem",
         .cert_file_name = "private/cert.pem"
     })
     .ws<PointerToPlayer>("/*", {
-        .open = [](auto *ws) {
-            ws->getUserData()->player = std::make_shared<Player>();
-            ws->getUserData()->player->set_type("player");
-            thread_clients.insert(ws);
+        .compression = CompressOptionsFor(server_config),
+        // Snapshots stop at backpressure_limit; this is only the hard ceiling
+        // past which uWS itself would drop frames, with room for the frames
+        // the simulation thread has already queued
+        .maxBackpressure = static_cast<unsigned int>(
+            std::max<size_t>(server_config.backpressure_limit * 8, 1 << 20)),
+        .open = [this](auto *ws) {
+            static std::atomic<uint64_t> next_client_id{1};
+            uint64_t id = next_client_id.fetch_add(1, std::memory_order_relaxed);
+            ws->getUserData()->client_id = id;
+            ws->getUserData()->connected_at = std::chrono::steady_clock::now();
+            thread_clients.Add(ws);  // Both modes, for PublishConnectionStats
+            if (simulation_) {
+                // The simulation thread owns the player; this side only keeps the socket
+                sockets_[id] = ws;
+                Command command;
+                command.kind = Command::Kind::kOpen;
+                command.worker = index_;
+                command.client = id;
+                simulation_->Push(std::move(command));
+            } else {
+                ws->getUserData()->player = std::make_shared<Player>();
+                ws->getUserData()->player->set_type("player");
+            }
             SystemMonitor::instance().increment_connections();
+            ClientCountChanged(+1);
             std::unique_lock<std::shared_mutex> lock(output_mtx);
             std::cout << "Client connected!" << std::endl;
         },
         .message = [this](auto *ws, std::string_view message, uWS::OpCode opCode) {
+            ws->getUserData()->bytes_in += message.size();
+            ws->getUserData()->messages_in++;
             HandleMessage(ws, message, opCode);
         },
-        .close = [](auto *ws, int /*code*/, std::string_view /*message*/) {
-            grid->Remove(ws->getUserData()->player);
-            thread_clients.erase(ws);
+        .drain = [this](auto *ws) {
+            // Resume once the socket is down to half the limit, so a client
+            // hovering at the limit does not flap every tick
+            auto *user_data = ws->getUserData();
+            if (!user_data->backpressured ||
+                ws->getBufferedAmount() > server_config.backpressure_limit / 2) {
+                return;
+            }
+            user_data->backpressured = false;
+            SystemMonitor::instance().client_backpressured(false);
+            if (simulation_) {
+                PushBackpressure(user_data->client_id, false);
+            }
+        },
+        .pong = [](auto *ws, std::string_view /*message*/) {
+            auto *user_data = ws->getUserData();
+            if (user_data->ping_sent == std::chrono::steady_clock::time_point{}) return;  // Unsolicited
+            user_data->rtt_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - user_data->ping_sent).count();
+            user_data->ping_sent = {};
+        },
+        .close = [this](auto *ws, int /*code*/, std::string_view /*message*/) {
+            if (ws->getUserData()->backpressured) {
+                SystemMonitor::instance().client_backpressured(false);
+            }
+            if (simulation_) {
+                sockets_.erase(ws->getUserData()->client_id);
+                Command command;
+                command.kind = Command::Kind::kClose;
+                command.client = ws->getUserData()->client_id;
+                simulation_->Push(std::move(command));
+            } else {
+                grid->Remove(ws->getUserData()->player);
+            }
+            thread_clients.Remove(ws);
             SystemMonitor::instance().decrement_connections();
+            ClientCountChanged(-1);
             std::unique_lock<std::shared_mutex> lock(output_mtx);
             std::cout << "Client disconnected!" << std::endl;
         }
@@ -349,13 +835,38 @@ void ServerWorker::StartServer(int port) {
         }
     });
 
+    app_ = &sslApp;
+    loop_.store(uWS::Loop::get(), std::memory_order_release);
+    if (balancer) {
+        sslApp.preOpen(RouteAcceptedSocket);
+        balancer->Attach(index_, [this](int fd) {
+            loop_.load(std::memory_order_acquire)->defer([this, fd] {
+                app_->adoptSocket(fd);
+                balancer->Adopted(index_);
+            });
+        });
+    }
+
     struct us_loop_t *loop = (struct us_loop_t *) uWS::Loop::get();
-    struct us_timer_t *playerTimer = us_create_timer(loop, 0, 0);
-    us_timer_set(playerTimer, HandleThreadClients, 20, 10);  // 10ms (100Hz) - MessagePack optimization allows faster updates
+    struct us_timer_t *statsTimer = us_create_timer(loop, 0, 0);
+    us_timer_set(statsTimer, PublishConnectionStats,
+                 constants::CONNECTION_STATS_PERIOD_MS, constants::CONNECTION_STATS_PERIOD_MS);
+
+    if (simulation_) {
+        // Game logic runs on the simulation thread; it wakes this loop when
+        // there are frames to send.
+        sslApp.run();
+        return;
+    }
 
-    // Timer for snowball position updates (every 250ms)
-    struct us_timer_t *objectTimer = us_create_timer(loop, 0, 0);
-    us_timer_set(objectTimer, HandleThreadObjects, 250, 30);  // Keep objects at 30ms
+    // One timer drives the fixed-timestep scheduler. It is one-shot: each
+    // HandleTick runs the due ticks and sets it for the scheduler's next
+    // deadline, so rates that are not a whole number of milliseconds do not
+    // fire early and wait out a whole extra period.
+    thread_scheduler = std::make_unique<TickScheduler>(server_config.tick_rate, server_config.max_catch_up);
+    struct us_timer_t *tickTimer = us_create_timer(loop, 0, 0);
+    us_timer_set(tickTimer, HandleTick, 1, 0);
+    OpenTickLog(thread_tick_log, "worker-" + std::to_string(index_));
 
     sslApp.run();
 }
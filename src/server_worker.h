@@ -7,6 +7,8 @@
 #include <unordered_set>
 #include <memory>
 #include <thread>
+#include <atomic>
+#include <unordered_map>
 #include <uWebSockets/App.h>
 
 #include "nlohmann/json.hpp"
@@ -14,26 +16,77 @@
 #include "grid.h"
 #include "game_object.h"
 #include "constants.h"
+#include "snapshot_codec.h"
+#include "message_schema.h"
+#include "connection_balancer.h"
+#include "client_registry.h"
+#include "task_pool.h"
+#include "worker_mailbox.h"
+#include "tick_log.h"
+#include "connection_stats.h"
 
 extern std::shared_mutex output_mtx;
 extern std::shared_ptr<Grid> grid;
 
-extern thread_local std::unordered_set<uWS::WebSocket<true, true, PointerToPlayer>*> thread_clients;
+using ClientSocket = uWS::WebSocket<true, true, PointerToPlayer>;
+
+extern thread_local ClientRegistry<ClientSocket> thread_clients;
 extern thread_local std::unordered_map<std::string, std::shared_ptr<GameObject>> thread_objects;
 
+class Simulation;
+
+// Game logic shared by the per-worker timers and the simulation thread.
+// BuildPlayerView returns a view into thread_local buffers, valid until the
+// next call on the same thread.
+// view_scale shrinks the view box under load (see DegradationController).
+// check_hits = false leaves hit detection to an earlier CheckPlayerCollisions.
+std::string_view BuildPlayerView(PointerToPlayer &client, long long current_time, double view_scale = 1.0,
+                                 bool check_hits = true);
+// Builds every client's view into frames[i] across view_pool (which must be
+// set). Hits are resolved serially first, so the parallel builds only read
+// shared objects.
+void BuildPlayerViews(const std::vector<PointerToPlayer*>& clients, long long current_time, double view_scale,
+                      std::vector<std::string>& frames);
+void UpdateThreadObjects(long long current_time);
+// Hit detection alone, for ticks where the client's snapshot is shed.
+void CheckPlayerCollisions(PointerToPlayer &client, long long current_time);
+
+// Pins the calling thread to `cpu` with node-local allocation; no-op for cpu < 0.
+void PlaceCurrentThread(const char *name, int cpu);
+// Opens <--tick-log>/ticks-<thread_name>.bin, if tick logging is on.
+void OpenTickLog(TickLog& log, const std::string& thread_name);
+
 class ServerWorker {
     std::thread worker_thread_;
+
+    int index_;
+    std::atomic<uWS::Loop *> loop_{nullptr};
+    uWS::SSLApp *app_ = nullptr;
+    size_t client_count_ = 0; // Loop thread only
+
+    // Simulation mode only (simulation_ != nullptr)
+    Simulation *simulation_;
+    std::unordered_map<uint64_t, uWS::WebSocket<true, true, PointerToPlayer>*> sockets_; // Loop thread only
 public:
-    ServerWorker();
-    void Start(int port);
+    // With a simulation, this worker only does socket I/O: it decodes
+    // messages into commands for the simulation and sends the frames it returns.
+    ServerWorker(int index, Simulation *simulation = nullptr);
+    // cpu >= 0 pins the worker thread to that CPU (see thread_affinity.h).
+    void Start(int port, int cpu = -1);
+
+    static void handleJoin(PointerToPlayer &client, const ClientMessage &message);
+    static void handleMovement(PointerToPlayer &client, const ClientMessage &message);
 protected:
-    void StartServer(int port);
+    void StartServer(int port, int cpu);
 
     void HandleMessage(auto *ws, std::string_view str_message, uWS::OpCode opCode);
 
-    void handlePing(auto *ws, const json &message, uWS::OpCode opCode);
-    void handleJoin(auto *ws, const json &message, const std::shared_ptr<Player>& player_ptr);
-    void handleMovement(auto *ws, const json &message, const std::shared_ptr<Player>& player_ptr);
+    void handlePing(auto *ws, const ClientMessage &message, uWS::OpCode opCode);
+
+    void ClientCountChanged(int delta);
+    void WakeForOutbound();
+    void DrainOutbound();
+    void PushBackpressure(uint64_t client, bool backpressured);
 };
 
 #endif
@@ -0,0 +1,212 @@
+#include "simulation.h"
+
+#include "grid.h"
+#include "profiler.h"
+#include "server_worker.h"
+#include "config.h"
+#include "constants.h"
+#include "tick_scheduler.h"
+#include "cpu_profiler.h"
+
+namespace {
+    long long SinceUs(std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end) {
+        return std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+    }
+}
+
+void Simulation::AddWorker(int index, Wake wake) {
+    if (static_cast<size_t>(index) >= workers_.size()) {
+        workers_.resize(index + 1);
+    }
+    workers_[index] = std::make_unique<Worker>();
+    workers_[index]->wake = std::move(wake);
+}
+
+void Simulation::Start(int cpu) {
+    thread_ = std::thread(&Simulation::Run, this, cpu);
+}
+
+void Simulation::Push(Command command) {
+    command.enqueued = std::chrono::steady_clock::now();
+    inbound_.Push(std::move(command));
+}
+
+void Simulation::Run(int cpu) {
+    PlaceCurrentThread("Simulation", cpu);
+    Tracer::instance().SetThreadName("Simulation");
+    CpuProfiler::instance().RegisterThread("Simulation");
+    OpenTickLog(tick_log_, "simulation");
+
+    TickScheduler scheduler(server_config.tick_rate, server_config.max_catch_up);
+    int object_every = scheduler.TicksPer(constants::OBJECT_UPDATE_PERIOD_MS);
+
+    while (true) {
+        scheduler.RunDue([&](long long tick, long long current_time) {
+            PROFILE_SCOPE("Simulation_Tick");
+            auto tick_wall = std::chrono::system_clock::now();
+            auto tick_start = std::chrono::steady_clock::now();
+            ApplyCommands();
+            auto input_end = std::chrono::steady_clock::now();
+            UpdateClients(tick, current_time);
+            auto views_end = std::chrono::steady_clock::now();
+            if (tick % object_every == 0) {
+                UpdateThreadObjects(current_time);
+            }
+            FlushOutbound();
+            auto tick_end = std::chrono::steady_clock::now();
+            long long tick_us = SinceUs(tick_start, tick_end);
+            if (tick_log_.is_open()) {
+                TickRecord record;
+                record.tick = static_cast<uint64_t>(tick);
+                record.unix_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                    tick_wall.time_since_epoch()).count();
+                record.duration_us = static_cast<uint32_t>(tick_us);
+                record.input_us = static_cast<uint32_t>(SinceUs(tick_start, input_end));
+                record.views_us = static_cast<uint32_t>(SinceUs(input_end, views_end));
+                record.objects_us = static_cast<uint32_t>(SinceUs(views_end, tick_end));
+                record.clients = static_cast<uint32_t>(clients_.size());
+                record.objects = static_cast<uint32_t>(thread_objects.size());
+                record.degradation_level = static_cast<uint32_t>(degradation_.level());
+                tick_log_.Append(record);
+            }
+            degradation_.Observe(tick_us,
+                std::chrono::duration_cast<std::chrono::microseconds>(scheduler.interval()).count());
+            SystemMonitor::instance().set_degradation_level(0, degradation_.level());
+            SystemMonitor::instance().record_thread_tick(0, tick_us);
+        });
+        std::this_thread::sleep_until(scheduler.next_deadline());
+    }
+}
+
+void Simulation::ApplyCommands() {
+    PROFILE_SCOPE("Simulation_ApplyCommands");
+    SystemMonitor::instance().set_inbound_queue_depth(inbound_.size());
+
+    Command command;
+    [[maybe_unused]] auto now = std::chrono::steady_clock::now();
+    while (inbound_.TryPop(command)) {
+        PROFILE_RECORD("QUEUE_WAIT:inbound", SinceUs(command.enqueued, now));
+
+        switch (command.kind) {
+        case Command::Kind::kOpen: {
+            auto& client = clients_[command.client];
+            client.worker = command.worker;
+            client.state.client_id = command.client;
+            client.state.player = std::make_shared<Player>();
+            client.state.player->set_type("player");
+            break;
+        }
+        case Command::Kind::kMessage: {
+            auto it = clients_.find(command.client);
+            if (it == clients_.end()) break;
+            if (command.message.type == "join") {
+                ServerWorker::handleJoin(it->second.state, command.message);
+            } else if (command.message.type == "movement") {
+                ServerWorker::handleMovement(it->second.state, command.message);
+            }
+            break;
+        }
+        case Command::Kind::kBackpressure: {
+            auto it = clients_.find(command.client);
+            if (it == clients_.end()) break;
+            it->second.state.backpressured = command.backpressured;
+            break;
+        }
+        case Command::Kind::kClose: {
+            auto it = clients_.find(command.client);
+            if (it == clients_.end()) break;
+            grid->Remove(it->second.state.player);
+            clients_.erase(it);
+            break;
+        }
+        }
+    }
+}
+
+void Simulation::UpdateClients(long long tick, long long current_time) {
+    PROFILE_SCOPE("Simulation_UpdateClients");
+    size_t shed = 0;
+    size_t dropped = 0;
+    batch_ids_.clear();
+    batch_clients_.clear();
+    for (auto& [id, client] : clients_) {
+        auto& player_ptr = client.state.player;
+        // Dead players stop receiving views once a frame has carried their
+        // death, as on the per-worker timer
+        bool dying = player_ptr->get_is_dead();
+        if (dying && client.state.pending_events.empty()) {
+            continue;
+        }
+        if (!dying && player_ptr->Expired(current_time)) {
+            grid->Remove(player_ptr);
+            continue;
+        }
+
+        // The I/O thread still has frames queued for this socket; the next
+        // one after it drains carries the newest state, a death included
+        if (client.state.backpressured) {
+            CheckPlayerCollisions(client.state, current_time);
+            client.state.dropped_snapshots++;
+            dropped++;
+            continue;
+        }
+
+        if (!dying && !degradation_.ShouldSend(tick, id, player_ptr->get_time_update(), current_time)) {
+            CheckPlayerCollisions(client.state, current_time);
+            // Shedding never holds back a death: the killing tick sends it
+            if (!player_ptr->get_is_dead()) {
+                shed++;
+                continue;
+            }
+        }
+
+        if (view_pool) {
+            batch_ids_.push_back(id);
+            batch_clients_.push_back(&client.state);
+            continue;
+        }
+        std::string_view frame = BuildPlayerView(client.state, current_time, degradation_.view_scale());
+        if (frame.empty()) continue;
+
+        OutboundFrame out;
+        out.client = id;
+        out.frame.assign(frame.data(), frame.size());
+        out.dropped_snapshots = client.state.dropped_snapshots;
+        Enqueue(client.worker, std::move(out));
+    }
+
+    if (!batch_clients_.empty()) {
+        BuildPlayerViews(batch_clients_, current_time, degradation_.view_scale(), batch_frames_);
+        for (size_t i = 0; i < batch_clients_.size(); i++) {
+            if (batch_frames_[i].empty()) continue;
+            OutboundFrame out;
+            out.client = batch_ids_[i];
+            out.frame = std::move(batch_frames_[i]);
+            out.dropped_snapshots = batch_clients_[i]->dropped_snapshots;
+            Enqueue(clients_[batch_ids_[i]].worker, std::move(out));
+        }
+    }
+    if (shed) SystemMonitor::instance().add_snapshots_shed(shed);
+    if (dropped) SystemMonitor::instance().add_snapshots_dropped_backpressure(dropped);
+}
+
+void Simulation::Enqueue(int worker_index, OutboundFrame out) {
+    out.enqueued = std::chrono::steady_clock::now();
+    SystemMonitor::instance().add_bytes_sent(out.frame.size());
+    auto& worker = *workers_[worker_index];
+    worker.queue.Push(std::move(out));
+    worker.has_frames = true;
+}
+
+void Simulation::FlushOutbound() {
+    size_t depth = 0;
+    for (auto& worker : workers_) {
+        if (!worker) continue;
+        depth += worker->queue.size();
+        if (worker->has_frames) {
+            worker->has_frames = false;
+            worker->wake();
+        }
+    }
+    SystemMonitor::instance().set_outbound_queue_depth(depth);
+}
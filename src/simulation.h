@@ -0,0 +1,96 @@
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "nlohmann/json.hpp"
+
+#include "game_object.h"
+#include "message_schema.h"
+#include "mpsc_queue.h"
+#include "degradation.h"
+#include "tick_log.h"
+
+// Inbound work decoded by an I/O thread.
+struct Command {
+    enum class Kind { kOpen, kMessage, kClose, kBackpressure };
+
+    Kind kind = Kind::kMessage;
+    int worker = 0;       // kOpen: the I/O worker that owns the socket
+    uint64_t client = 0;
+    nlohmann::json document;  // Owns the strings `message` views into (moves keep them in place)
+    ClientMessage message;
+    bool backpressured = false;  // kBackpressure: the socket went over (true) or drained below the limit
+    std::chrono::steady_clock::time_point enqueued;
+};
+
+// A finished batch_update on its way back to the client's I/O thread.
+struct OutboundFrame {
+    uint64_t client = 0;
+    std::string frame;
+    std::chrono::steady_clock::time_point enqueued;
+    uint64_t dropped_snapshots = 0; // The client's running total, for its connection stats
+};
+
+// Runs all game logic on one dedicated thread. I/O workers push decoded
+// commands; every tick the simulation applies them, builds each client's
+// view and hands the frames back on that worker's outbound queue, then calls
+// the worker's wake callback so it drains the queue on its own loop.
+class Simulation {
+public:
+    using Wake = std::function<void()>;
+
+    Simulation() = default;
+    Simulation(const Simulation&) = delete;
+    Simulation& operator=(const Simulation&) = delete;
+
+    // Registers I/O worker `index`. Call before Start().
+    void AddWorker(int index, Wake wake);
+    // cpu >= 0 pins the simulation thread to that CPU.
+    void Start(int cpu = -1);
+
+    // Any thread.
+    void Push(Command command);
+
+    // Consumed by worker `index` only.
+    MpscQueue<OutboundFrame>& outbound(int index) { return workers_[index]->queue; }
+
+private:
+    struct Worker {
+        MpscQueue<OutboundFrame> queue;
+        Wake wake;
+        bool has_frames = false;
+    };
+
+    struct Client {
+        int worker = 0;
+        PointerToPlayer state;
+    };
+
+    void Run(int cpu);
+    void ApplyCommands();
+    void UpdateClients(long long tick, long long current_time);
+    void Enqueue(int worker, OutboundFrame out);
+    void FlushOutbound();
+
+    MpscQueue<Command> inbound_;
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::unordered_map<uint64_t, Client> clients_; // Simulation thread only
+    DegradationController degradation_;
+    TickLog tick_log_;
+    // Clients due a snapshot this tick when builds go through view_pool
+    std::vector<uint64_t> batch_ids_;
+    std::vector<PointerToPlayer*> batch_clients_;
+    std::vector<std::string> batch_frames_;
+    std::thread thread_;
+};
+
+#endif
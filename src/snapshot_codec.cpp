@@ -0,0 +1,152 @@
+#include "snapshot_codec.h"
+#include "game_object.h"
+#include "profiler.h"
+
+#include <cmath>
+
+namespace snapshot_codec {
+
+namespace {
+    int32_t Quantize(double value, int scale, int bits) {
+        const int32_t limit = (1 << (bits - 1)) - 1;
+        long long q = std::llround(value * scale);
+        return static_cast<int32_t>(std::clamp<long long>(q, -limit, limit));
+    }
+
+    uint32_t QuantizeUnsigned(double value, int scale, int bits) {
+        const long long limit = (1ll << bits) - 1;
+        long long q = std::llround(value * scale);
+        return static_cast<uint32_t>(std::clamp<long long>(q, 0, limit));
+    }
+
+    int BitWidth(uint32_t value) {
+        int bits = 1;
+        while (bits < 16 && (value >> bits) != 0) bits++;
+        return bits;
+    }
+}
+
+void Encode(BitWriter& out, const InterestSet& interest, const std::vector<GameEvent>& events,
+            double viewer_x, double viewer_y, long long current_time) {
+    PROFILE_SCOPE("snapshot_codec::Encode");
+    out.Clear();
+
+    // Slots are written with the smallest width that fits this frame
+    uint32_t max_slot = 0;
+    for (const auto* entry : interest.updates()) max_slot = std::max<uint32_t>(max_slot, entry->slot);
+    for (uint16_t slot : interest.despawns()) max_slot = std::max<uint32_t>(max_slot, slot);
+    const int slot_bits = BitWidth(max_slot);
+
+    const uint32_t origin_x = QuantizeUnsigned(viewer_x, kPositionScale, kOriginBits);
+    const uint32_t origin_y = QuantizeUnsigned(viewer_y, kPositionScale, kOriginBits);
+
+    out.Write(kPackedSnapshotMagic, 8);
+    out.Write64(static_cast<uint64_t>(current_time), kTimestampBits);
+    out.Write(origin_x, kOriginBits);
+    out.Write(origin_y, kOriginBits);
+    out.Write(static_cast<uint32_t>(slot_bits), 5);
+    out.Write(static_cast<uint32_t>(interest.spawns().size()), kCountBits);
+    out.Write(static_cast<uint32_t>(interest.updates().size()), kCountBits);
+    out.Write(static_cast<uint32_t>(interest.despawns().size()), kCountBits);
+
+    for (const auto* entry : interest.spawns()) {
+        const GameObject& obj = *entry->obj;
+        out.Write(entry->slot, slot_bits);
+        out.WriteString(obj.get_id());
+        out.WriteString(obj.get_type());
+        out.WriteString(obj.get_username());
+        out.Write(QuantizeUnsigned(obj.get_size(), kPositionScale, kSizeBits), kSizeBits);
+    }
+
+    const int32_t life_limit = (1 << kLifeBits) - 1;
+    for (const auto* entry : interest.updates()) {
+        const GameObject& obj = *entry->obj;
+        out.Write(entry->slot, slot_bits);
+        out.WriteSigned(Quantize(obj.get_cur_x(current_time) - origin_x / double(kPositionScale),
+                                 kPositionScale, kPositionBits), kPositionBits);
+        out.WriteSigned(Quantize(obj.get_cur_y(current_time) - origin_y / double(kPositionScale),
+                                 kPositionScale, kPositionBits), kPositionBits);
+        out.WriteSigned(Quantize(obj.get_vx(), kVelocityScale, kVelocityBits), kVelocityBits);
+        out.WriteSigned(Quantize(obj.get_vy(), kVelocityScale, kVelocityBits), kVelocityBits);
+        out.WriteBool(obj.get_charging());
+        out.WriteBool(obj.get_is_dead());
+        out.Write(static_cast<uint32_t>(std::clamp<long long>(obj.get_life_length(), 0, life_limit)), kLifeBits);
+        out.WriteSigned(Quantize(static_cast<double>(obj.get_time_update() - current_time), 1, kTimeDeltaBits),
+                        kTimeDeltaBits);
+        out.Write(static_cast<uint32_t>(std::clamp(obj.get_health(), 0, (1 << kHealthBits) - 1)), kHealthBits);
+    }
+
+    for (uint16_t slot : interest.despawns()) {
+        out.Write(slot, slot_bits);
+    }
+
+    const size_t event_count = std::min<size_t>(events.size(), (1u << kEventCountBits) - 1);
+    out.Write(static_cast<uint32_t>(event_count), kEventCountBits);
+    for (size_t i = 0; i < event_count; i++) {
+        const GameEvent& event = events[i];
+        out.Write(event.type, kEventTypeBits);
+        out.Write(static_cast<uint32_t>(std::clamp(event.health, 0, (1 << kHealthBits) - 1)), kHealthBits);
+        out.Write(static_cast<uint32_t>(std::clamp(event.damage, 0, (1 << kHealthBits) - 1)), kHealthBits);
+        out.WriteSigned(Quantize(static_cast<double>(event.time - current_time), 1, kTimeDeltaBits), kTimeDeltaBits);
+    }
+
+    out.Flush();
+}
+
+bool Decode(const uint8_t* data, size_t size, DecodedSnapshot& snapshot) {
+    BitReader in(data, size);
+    if (in.Read(8) != kPackedSnapshotMagic) return false;
+
+    snapshot.timestamp = static_cast<long long>(in.Read64(kTimestampBits));
+    const uint32_t origin_x = in.Read(kOriginBits);
+    const uint32_t origin_y = in.Read(kOriginBits);
+    snapshot.origin_x = origin_x / double(kPositionScale);
+    snapshot.origin_y = origin_y / double(kPositionScale);
+    const int slot_bits = static_cast<int>(in.Read(5));
+    const uint32_t spawn_count = in.Read(kCountBits);
+    const uint32_t update_count = in.Read(kCountBits);
+    const uint32_t despawn_count = in.Read(kCountBits);
+
+    snapshot.spawns.resize(spawn_count);
+    for (auto& spawn : snapshot.spawns) {
+        spawn.slot = static_cast<uint16_t>(in.Read(slot_bits));
+        spawn.id = in.ReadString();
+        spawn.object_type = in.ReadString();
+        spawn.username = in.ReadString();
+        spawn.size = in.Read(kSizeBits) / double(kPositionScale);
+    }
+
+    const uint32_t life_limit = (1u << kLifeBits) - 1;
+    snapshot.updates.resize(update_count);
+    for (auto& update : snapshot.updates) {
+        update.slot = static_cast<uint16_t>(in.Read(slot_bits));
+        update.x = (static_cast<int32_t>(origin_x) + in.ReadSigned(kPositionBits)) / double(kPositionScale);
+        update.y = (static_cast<int32_t>(origin_y) + in.ReadSigned(kPositionBits)) / double(kPositionScale);
+        update.vx = in.ReadSigned(kVelocityBits) / double(kVelocityScale);
+        update.vy = in.ReadSigned(kVelocityBits) / double(kVelocityScale);
+        update.charging = in.ReadBool();
+        update.is_dead = in.ReadBool();
+        uint32_t life = in.Read(kLifeBits);
+        update.long_lived = life == life_limit;
+        update.expire_date = snapshot.timestamp + life;
+        update.time_update = snapshot.timestamp + in.ReadSigned(kTimeDeltaBits);
+        update.health = static_cast<int>(in.Read(kHealthBits));
+    }
+
+    snapshot.despawns.resize(despawn_count);
+    for (auto& slot : snapshot.despawns) {
+        slot = static_cast<uint16_t>(in.Read(slot_bits));
+    }
+
+    snapshot.events.resize(in.Read(kEventCountBits));
+    for (auto& event : snapshot.events) {
+        event.type = static_cast<GameEvent::Type>(in.Read(kEventTypeBits));
+        event.health = static_cast<int>(in.Read(kHealthBits));
+        event.damage = static_cast<int>(in.Read(kHealthBits));
+        event.time = snapshot.timestamp + in.ReadSigned(kTimeDeltaBits);
+    }
+
+    return !in.overflowed();
+}
+
+}
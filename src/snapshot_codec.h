@@ -0,0 +1,78 @@
+#ifndef SNAPSHOT_CODEC_H
+#define SNAPSHOT_CODEC_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "bit_stream.h"
+#include "game_object.h"
+#include "interest_set.h"
+
+// Bit-packed alternative to the msgpack batch_update frame.
+//
+// Positions are quantized to 1/8 px relative to the viewer, velocities to
+// 1/2 px/s within +-1024 px/s, and timestamps become deltas against the frame
+// timestamp. Every frame starts with kPackedSnapshotMagic (0xC1, a byte msgpack
+// never emits) so clients can tell the two formats apart.
+namespace snapshot_codec {
+    constexpr uint8_t kPackedSnapshotMagic = 0xC1;
+
+    constexpr int kPositionScale = 8;          // 1/8 px
+    constexpr int kPositionBits = 16;          // +-4096 px around the viewer
+    constexpr int kOriginBits = 16;            // 0..8192 px absolute
+    constexpr int kVelocityScale = 2;          // 1/2 px/s
+    constexpr int kVelocityBits = 12;          // +-1024 px/s
+    constexpr int kSizeBits = 12;              // 0..512 px at 1/8 px
+    constexpr int kLifeBits = 16;              // ms; saturated means long-lived
+    constexpr int kTimeDeltaBits = 24;         // +-2.3 h against the frame timestamp
+    constexpr int kHealthBits = 8;
+    constexpr int kTimestampBits = 48;
+    constexpr int kCountBits = 16;
+    constexpr int kEventCountBits = 8;
+    constexpr int kEventTypeBits = 2;
+
+    // Typical encoded sizes per entry (see benchmark/codec_bench), for
+    // InterestSet::UpdateBudget
+    constexpr size_t kApproxSpawnBytes = 51;
+    constexpr size_t kApproxUpdateBytes = 14;
+
+    struct DecodedSpawn {
+        uint16_t slot;
+        std::string id, object_type, username;
+        double size;
+    };
+
+    struct DecodedUpdate {
+        uint16_t slot;
+        double x, y, vx, vy;
+        bool charging, is_dead, long_lived;
+        long long expire_date, time_update;
+        int health;
+    };
+
+    struct DecodedEvent {
+        GameEvent::Type type;
+        int health, damage;
+        long long time;
+    };
+
+    struct DecodedSnapshot {
+        long long timestamp = 0;
+        double origin_x = 0, origin_y = 0;
+        std::vector<DecodedSpawn> spawns;
+        std::vector<DecodedUpdate> updates;
+        std::vector<uint16_t> despawns;
+        std::vector<DecodedEvent> events;
+    };
+
+    // Encodes the result of the last InterestSet::Update() and the client's
+    // pending events into out (cleared first). At most 255 events are written.
+    void Encode(BitWriter& out, const InterestSet& interest, const std::vector<GameEvent>& events,
+                double viewer_x, double viewer_y, long long current_time);
+
+    // Returns false if the buffer is not a packed snapshot or is truncated.
+    [[nodiscard]] bool Decode(const uint8_t* data, size_t size, DecodedSnapshot& snapshot);
+}
+
+#endif
@@ -0,0 +1,94 @@
+#include "task_pool.h"
+
+#include <algorithm>
+
+#include "cpu_profiler.h"
+
+TaskPool::TaskPool(int threads, std::string name) {
+    threads = std::max(threads, 1);
+    for (int i = 0; i < threads; i++) {
+        queues_.push_back(std::make_unique<Queue>());
+    }
+    for (int i = 0; i < threads; i++) {
+        threads_.emplace_back(&TaskPool::Run, this, static_cast<size_t>(i), name + " " + std::to_string(i));
+    }
+}
+
+TaskPool::~TaskPool() {
+    {
+        std::lock_guard<std::mutex> lock(wake_mtx_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    for (auto& thread : threads_) thread.join();
+}
+
+void TaskPool::ParallelFor(size_t count, size_t grain, const Range& fn) {
+    if (count == 0) return;
+    grain = std::max<size_t>(grain, 1);
+    size_t chunks = (count + grain - 1) / grain;
+    if (chunks == 1) {
+        fn(0, count);
+        return;
+    }
+
+    Job job{&fn, {chunks}};
+    {
+        // Counted before they are pushed so a thief never takes queued_ below zero
+        std::lock_guard<std::mutex> lock(wake_mtx_);
+        queued_.fetch_add(chunks, std::memory_order_relaxed);
+    }
+    size_t queue = next_queue_.fetch_add(1, std::memory_order_relaxed);
+    for (size_t begin = 0; begin < count; begin += grain, queue++) {
+        auto& target = *queues_[queue % queues_.size()];
+        std::lock_guard<std::mutex> lock(target.mtx);
+        target.tasks.push_back(Task{&job, begin, std::min(begin + grain, count)});
+    }
+    wake_.notify_all();
+
+    // Help instead of blocking; this may run chunks of other threads' loops
+    size_t home = queue % queues_.size();
+    while (job.remaining.load(std::memory_order_acquire) > 0) {
+        if (!TryRunOne(home)) std::this_thread::yield();
+    }
+}
+
+bool TaskPool::TryRunOne(size_t home) {
+    Task task{};
+    bool found = false;
+    {
+        auto& own = *queues_[home];
+        std::lock_guard<std::mutex> lock(own.mtx);
+        if (!own.tasks.empty()) {
+            task = own.tasks.back();
+            own.tasks.pop_back();
+            found = true;
+        }
+    }
+    for (size_t i = 1; !found && i < queues_.size(); i++) {
+        auto& victim = *queues_[(home + i) % queues_.size()];
+        std::lock_guard<std::mutex> lock(victim.mtx);
+        if (!victim.tasks.empty()) {
+            task = victim.tasks.front();
+            victim.tasks.pop_front();
+            found = true;
+        }
+    }
+    if (!found) return false;
+
+    queued_.fetch_sub(1, std::memory_order_relaxed);
+    (*task.job->fn)(task.begin, task.end);
+    // Last use of the job: its owner may return as soon as this hits zero
+    task.job->remaining.fetch_sub(1, std::memory_order_release);
+    return true;
+}
+
+void TaskPool::Run(size_t index, std::string name) {
+    CpuProfiler::instance().RegisterThread(std::move(name));
+    while (true) {
+        if (TryRunOne(index)) continue;
+        std::unique_lock<std::mutex> lock(wake_mtx_);
+        wake_.wait(lock, [this] { return stop_ || queued_.load(std::memory_order_relaxed) > 0; });
+        if (stop_) return;
+    }
+}
@@ -0,0 +1,70 @@
+#ifndef TASK_POOL_H
+#define TASK_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Work-stealing pool for fork-join loops, shared by every game thread.
+//
+// ParallelFor() cuts [0, count) into chunks and deals them round-robin onto
+// the pool threads' deques. Each pool thread pops its own deque from the back
+// and, once that is empty, steals from the front of the others; the calling
+// thread steals too instead of sleeping, and returns once every chunk of its
+// loop has run. Several threads may run loops at once; their chunks share the
+// deques. Each deque has its own lock, held only to push or pop one chunk.
+class TaskPool {
+public:
+    using Range = std::function<void(size_t begin, size_t end)>;
+
+    // Pool threads are named "<name> N" in CPU profiles.
+    explicit TaskPool(int threads, std::string name = "Pool");
+    ~TaskPool();
+    TaskPool(const TaskPool&) = delete;
+    TaskPool& operator=(const TaskPool&) = delete;
+
+    // Calls fn(begin, end) over [0, count) in chunks of at most `grain`.
+    // fn must not call ParallelFor itself.
+    void ParallelFor(size_t count, size_t grain, const Range& fn);
+
+    [[nodiscard]] int threads() const { return static_cast<int>(threads_.size()); }
+
+private:
+    struct Job {
+        const Range *fn;
+        std::atomic<size_t> remaining;
+    };
+    struct Task {
+        Job *job;
+        size_t begin, end;
+    };
+    struct alignas(64) Queue {
+        std::mutex mtx;
+        std::deque<Task> tasks;
+    };
+
+    void Run(size_t index, std::string name);
+    // Runs one chunk from queue `home` (back) or any other queue (front).
+    bool TryRunOne(size_t home);
+
+    std::vector<std::unique_ptr<Queue>> queues_;
+    std::vector<std::thread> threads_;
+    std::atomic<size_t> next_queue_{0};  // Round-robin start for each loop's chunks
+
+    std::mutex wake_mtx_;
+    std::condition_variable wake_;
+    std::atomic<size_t> queued_{0};      // Chunks pushed and not yet popped
+    bool stop_ = false;
+};
+
+// Null when snapshot builds run serially on each game thread (--view-threads=0).
+extern std::shared_ptr<TaskPool> view_pool;
+
+#endif
@@ -0,0 +1,72 @@
+#include "thread_affinity.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <string>
+#include <thread>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace thread_affinity {
+
+std::vector<int> AllowedCpus() {
+    std::vector<int> cpus;
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+        for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+            if (CPU_ISSET(cpu, &set)) cpus.push_back(cpu);
+        }
+    }
+#endif
+    if (cpus.empty()) {
+        unsigned int count = std::max(std::thread::hardware_concurrency(), 1u);
+        for (unsigned int cpu = 0; cpu < count; cpu++) cpus.push_back(static_cast<int>(cpu));
+    }
+    return cpus;
+}
+
+int NodeOfCpu(int cpu) {
+    // /sys/devices/system/cpu/cpuN/nodeM exists on NUMA kernels
+    std::error_code ec;
+    std::filesystem::path dir = "/sys/devices/system/cpu/cpu" + std::to_string(cpu);
+    for (const auto& entry : std::filesystem::directory_iterator(dir, ec)) {
+        std::string name = entry.path().filename().string();
+        if (name.rfind("node", 0) == 0 && name.size() > 4) {
+            try {
+                return std::stoi(name.substr(4));
+            } catch (const std::exception&) {
+            }
+        }
+    }
+    return -1;
+}
+
+bool PinCurrentThread(int cpu) {
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    (void)cpu;
+    return false;
+#endif
+}
+
+bool UseLocalMemoryPolicy() {
+#if defined(__linux__) && defined(SYS_set_mempolicy)
+    constexpr int kMpolLocal = 4;  // MPOL_LOCAL from <linux/mempolicy.h>
+    return syscall(SYS_set_mempolicy, kMpolLocal, nullptr, 0) == 0;
+#else
+    return false;
+#endif
+}
+
+}
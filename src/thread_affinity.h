@@ -0,0 +1,25 @@
+#ifndef THREAD_AFFINITY_H
+#define THREAD_AFFINITY_H
+
+#include <vector>
+
+// CPU pinning and NUMA placement for worker threads (Linux; no-ops elsewhere).
+namespace thread_affinity {
+    // CPUs the process may run on (respects taskset/cgroup masks); never empty.
+    [[nodiscard]] std::vector<int> AllowedCpus();
+
+    // NUMA node the CPU belongs to, or -1 if unknown (non-NUMA or no sysfs).
+    [[nodiscard]] int NodeOfCpu(int cpu);
+
+    // Pins the calling thread to `cpu`. Returns false if the kernel refused.
+    [[nodiscard]] bool PinCurrentThread(int cpu);
+
+    // Makes the calling thread's future allocations come from the node it is
+    // running on (MPOL_LOCAL), overriding any inherited policy such as
+    // `numactl --interleave`. Combined with pinning, everything a worker
+    // allocates (players, snowballs, buffers) stays on its own node.
+    // Uses the raw syscall so the server does not depend on libnuma.
+    [[nodiscard]] bool UseLocalMemoryPolicy();
+}
+
+#endif
@@ -0,0 +1,49 @@
+#include "tick_log.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cstring>
+
+TickLog::~TickLog() {
+    if (header_) munmap(header_, mapped_bytes_);
+}
+
+bool TickLog::Open(const std::string& path, uint64_t capacity) {
+    if (header_ || capacity == 0) return false;
+    size_t bytes = sizeof(TickLogHeader) + capacity * sizeof(TickRecord);
+
+    int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return false;
+    if (ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+        close(fd);
+        return false;
+    }
+    void *mapped = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);  // The mapping keeps the file open
+    if (mapped == MAP_FAILED) return false;
+
+    header_ = static_cast<TickLogHeader *>(mapped);
+    records_ = reinterpret_cast<TickRecord *>(header_ + 1);
+    mapped_bytes_ = bytes;
+    header_->record_size = sizeof(TickRecord);
+    header_->capacity = capacity;
+    header_->head.store(0, std::memory_order_relaxed);
+    std::memcpy(header_->magic, TickLogHeader::kMagic, sizeof(header_->magic));
+    last_ = thread_counters();
+    return true;
+}
+
+void TickLog::Append(TickRecord record) {
+    if (!header_) return;
+    const ThreadCounters& now = thread_counters();
+    record.grid_ops = static_cast<uint32_t>(now.grid_ops - last_.grid_ops);
+    record.bytes_sent = static_cast<uint32_t>(now.bytes_sent - last_.bytes_sent);
+    record.lock_wait_us = static_cast<uint32_t>((now.lock_wait_ns - last_.lock_wait_ns) / 1000);
+    last_ = now;
+
+    uint64_t head = header_->head.load(std::memory_order_relaxed);
+    records_[head % header_->capacity] = record;
+    header_->head.store(head + 1, std::memory_order_release);
+}
@@ -0,0 +1,74 @@
+#ifndef TICK_LOG_H
+#define TICK_LOG_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#include "profiler.h"
+
+// One game tick, as stored in the tick log. Fixed size so the file is an
+// array; readers check record_size in the header.
+struct TickRecord {
+    uint64_t tick = 0;
+    int64_t unix_us = 0;           // Wall clock at the start of the tick
+    uint32_t duration_us = 0;
+    // Phases: input is the mailbox (inline) or the command queue (simulation);
+    // views is building and sending/queuing snapshots; objects is snowball updates
+    uint32_t input_us = 0;
+    uint32_t views_us = 0;
+    uint32_t objects_us = 0;
+    uint32_t clients = 0;
+    uint32_t objects = 0;
+    uint32_t bytes_sent = 0;       // Frames sent (inline) or queued for the I/O threads (simulation)
+    uint32_t grid_ops = 0;         // Including searches run for this thread on the view pool
+    uint32_t lock_wait_us = 0;     // Waiting for grid cell locks, pool included; 0 below PROFILE_LEVEL_TIMING
+    uint32_t degradation_level = 0;
+    uint32_t reserved[2] = {};
+};
+static_assert(sizeof(TickRecord) == 64);
+
+// Header at the start of a tick log file, followed by `capacity` records.
+// Record i is written to slot i % capacity, then `head` becomes i + 1, so the
+// newest `capacity` ticks are in the file at any time.
+struct TickLogHeader {
+    static constexpr char kMagic[8] = {'S', 'F', 'T', 'I', 'C', 'K', 'S', '1'};
+
+    char magic[8];
+    uint32_t record_size;
+    uint32_t reserved;
+    uint64_t capacity;
+    std::atomic<uint64_t> head;    // Records ever written
+    uint8_t padding[32];
+};
+static_assert(sizeof(TickLogHeader) == 64);
+
+// Per-tick telemetry of one game thread, appended to a memory-mapped ring
+// file (--tick-log). Append is a 64-byte copy into the mapping; the kernel
+// writes the pages back, so the file survives a crash of the server.
+// Owned by a single thread.
+class TickLog {
+public:
+    TickLog() = default;
+    ~TickLog();
+    TickLog(const TickLog&) = delete;
+    TickLog& operator=(const TickLog&) = delete;
+
+    // Creates (or replaces) `path` with room for `capacity` records. Returns
+    // false and stays closed if the file cannot be created or mapped.
+    bool Open(const std::string& path, uint64_t capacity);
+
+    [[nodiscard]] bool is_open() const { return header_ != nullptr; }
+
+    // Fills in this thread's grid ops, bytes sent and lock wait since the
+    // previous Append (from thread_counters()) and stores the record.
+    void Append(TickRecord record);
+
+private:
+    TickLogHeader *header_ = nullptr;
+    TickRecord *records_ = nullptr;
+    size_t mapped_bytes_ = 0;
+    ThreadCounters last_;
+};
+
+#endif
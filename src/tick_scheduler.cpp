@@ -0,0 +1,18 @@
+#include "tick_scheduler.h"
+
+#include <algorithm>
+#include <cmath>
+
+TickScheduler::TickScheduler(int tick_rate, int max_catch_up)
+    : tick_rate_(std::max(tick_rate, 1)),
+      interval_(std::chrono::nanoseconds(1'000'000'000LL / tick_rate_)),
+      max_catch_up_(std::max(max_catch_up, 0)),
+      start_(Clock::now()),
+      next_(start_) {
+    auto now = std::chrono::system_clock::now();
+    start_time_ms_ = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count();
+}
+
+int TickScheduler::TicksPer(int period_ms) const {
+    return std::max(1, static_cast<int>(std::lround(period_ms * tick_rate_ / 1000.0)));
+}
@@ -0,0 +1,91 @@
+#ifndef TICK_SCHEDULER_H
+#define TICK_SCHEDULER_H
+
+#include <chrono>
+#include <cstdint>
+
+#include "profiler.h"
+
+// Fixed-timestep tick clock.
+//
+// Tick n is due at start + n / tick_rate seconds and simulates game time
+// start_time_ms + n * 1000 / tick_rate, however late it actually runs. Both
+// are computed from n rather than by adding up a rounded interval, so rates
+// that do not divide a second evenly keep an exact average period. RunDue() runs
+// every tick that has come due since the last call, back to back, but at most
+// 1 + max_catch_up of them; anything beyond that is dropped (the tick counter
+// jumps ahead) so a long stall cannot snowball into a burst of work. A tick
+// that takes longer than the interval counts as an overrun.
+class TickScheduler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    TickScheduler(int tick_rate, int max_catch_up);
+
+    // Calls tick(tick_number, game_time_ms) for each due tick. Returns how many ran.
+    template <typename Tick>
+    int RunDue(Tick&& tick) {
+        auto now = Clock::now();
+        if (now < next_) return 0;
+
+        long long due = (now - next_) / interval_ + 1;
+        long long allowed = 1 + max_catch_up_;
+        if (due > allowed) {
+            long long dropped = due - allowed;
+            tick_ += dropped;
+            next_ = Deadline(tick_);
+            dropped_ += dropped;
+            SystemMonitor::instance().add_dropped_ticks(dropped);
+        }
+
+        int ran = 0;
+        while (next_ <= now && ran < allowed) {
+            auto start = Clock::now();
+            tick(tick_, GameTimeMs(tick_));
+            auto duration = Clock::now() - start;
+
+            bool overrun = duration > interval_;
+            if (overrun) overruns_++;
+            SystemMonitor::instance().record_tick(
+                std::chrono::duration_cast<std::chrono::microseconds>(duration).count(), overrun);
+
+            tick_++;
+            next_ = Deadline(tick_);
+            ran++;
+        }
+        return ran;
+    }
+
+    // Game time the given tick simulates, in epoch milliseconds.
+    [[nodiscard]] long long GameTimeMs(long long tick) const {
+        return start_time_ms_ + tick * 1000 / tick_rate_;
+    }
+
+    [[nodiscard]] Clock::time_point next_deadline() const { return next_; }
+    [[nodiscard]] Clock::duration interval() const { return interval_; }
+    [[nodiscard]] long long tick() const { return tick_; }
+    [[nodiscard]] long long overruns() const { return overruns_; }
+    [[nodiscard]] long long dropped() const { return dropped_; }
+
+    // Ticks in `period_ms` at this rate (at least 1), for phases that run less often.
+    [[nodiscard]] int TicksPer(int period_ms) const;
+
+private:
+    [[nodiscard]] Clock::time_point Deadline(long long tick) const {
+        // Whole seconds apart so tick * 1e9 cannot overflow on a long run
+        return start_ + std::chrono::seconds(tick / tick_rate_) +
+               std::chrono::nanoseconds(tick % tick_rate_ * 1'000'000'000LL / tick_rate_);
+    }
+
+    int tick_rate_;
+    Clock::duration interval_;      // Nominal, for overruns; deadlines use Deadline()
+    int max_catch_up_;
+    Clock::time_point start_;
+    Clock::time_point next_;
+    long long start_time_ms_;
+    long long tick_ = 0;
+    long long overruns_ = 0;
+    long long dropped_ = 0;
+};
+
+#endif
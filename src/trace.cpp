@@ -0,0 +1,95 @@
+#include "trace.h"
+
+#include <signal.h>
+#include <time.h>
+
+#include <cstdio>
+#include <fstream>
+
+#include "profiler.h"
+
+// Steady-clock time of the last SIGUSR2, 0 once handled
+static std::atomic<long long> dump_requested_ns{0};
+
+static void HandleDumpSignal(int) {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);  // steady_clock's clock, and signal-safe
+    dump_requested_ns.store(ts.tv_sec * 1000000000LL + ts.tv_nsec, std::memory_order_relaxed);
+}
+
+void Tracer::InstallDumpSignal() {
+    struct sigaction action = {};
+    action.sa_handler = HandleDumpSignal;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART;
+    sigaction(SIGUSR2, &action, nullptr);
+}
+
+std::string Tracer::DumpIfRequested(long long window_ms) {
+    long long end_ns = dump_requested_ns.exchange(0, std::memory_order_relaxed);
+    if (end_ns == 0 || !enabled()) return "";
+    std::string path = "trace-" + std::to_string(time(nullptr)) + ".json";
+    return WriteChromeTrace(path, end_ns, window_ms * 1000000LL) ? path : "";
+}
+
+// Scope names are identifiers and literals, but keep the JSON valid anyway
+static void AppendEscaped(std::string& out, const std::string& text) {
+    for (char c : text) {
+        if (c == '"' || c == '\\') out += '\\';
+        if (static_cast<unsigned char>(c) < 0x20) continue;
+        out += c;
+    }
+}
+
+bool Tracer::WriteChromeTrace(const std::string& path, long long end_ns, long long window_ns) {
+    std::vector<std::string> names = Profiler::instance().names();
+    struct Span {
+        long long start_ns, duration_ns;
+        uint32_t scope;
+    };
+
+    std::string out = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    bool first = true;
+    char line[128];
+    std::unique_lock<std::mutex> lock(rings_mtx_);
+    for (size_t tid = 0; tid < rings_.size(); tid++) {
+        const Ring& ring = *rings_[tid];
+        uint64_t head = ring.head.load(std::memory_order_acquire);
+        uint64_t capacity = ring.mask + 1;
+        uint64_t begin = head > capacity ? head - capacity : 0;
+        std::vector<Span> spans;
+        spans.reserve(head - begin);
+        for (uint64_t i = begin; i < head; i++) {
+            const Event& event = ring.events[i & ring.mask];
+            spans.push_back({event.start_ns.load(std::memory_order_relaxed),
+                             event.duration_ns.load(std::memory_order_relaxed),
+                             event.scope.load(std::memory_order_relaxed)});
+        }
+        // The owner kept writing: slots it reached since `head` may be torn
+        uint64_t after = ring.head.load(std::memory_order_acquire);
+        size_t skip = after >= capacity + begin ? std::min<uint64_t>(after - capacity - begin + 1, spans.size()) : 0;
+
+        out += first ? "" : ",\n";
+        first = false;
+        out += "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" + std::to_string(tid) + ",\"args\":{\"name\":\"";
+        AppendEscaped(out, ring.name.empty() ? "Thread " + std::to_string(tid) : ring.name);
+        out += "\"}}";
+        for (size_t i = skip; i < spans.size(); i++) {
+            const Span& span = spans[i];
+            long long span_end = span.start_ns + span.duration_ns;
+            if (span_end < end_ns - window_ns || span_end > end_ns || span.scope >= names.size() ||
+                names[span.scope].empty()) continue;
+            out += ",\n{\"name\":\"";
+            AppendEscaped(out, names[span.scope]);
+            std::snprintf(line, sizeof(line), "\",\"ph\":\"X\",\"pid\":1,\"tid\":%zu,\"ts\":%.3f,\"dur\":%.3f}",
+                          tid, span.start_ns / 1e3, span.duration_ns / 1e3);
+            out += line;
+        }
+    }
+    lock.unlock();
+    out += "\n]}\n";
+
+    std::ofstream file(path, std::ios::binary);
+    file << out;
+    return static_cast<bool>(file);
+}
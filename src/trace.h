@@ -0,0 +1,95 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Span tracer for PROFILE_SCOPE and TimedLock, exported as Chrome trace-event
+// JSON (opens in Perfetto or chrome://tracing).
+//
+// Off unless Enable() is called at startup (--trace-events). Each thread then
+// appends one fixed-size event per finished scope to its own ring, which
+// overwrites the oldest events, so only the last few seconds are kept. A
+// dump reads the rings while they are being written: events the owner may
+// have overwritten during the copy are dropped instead of locking the writer.
+class Tracer {
+public:
+    static Tracer& instance() {
+        static Tracer inst;
+        return inst;
+    }
+
+    // Events kept per thread (rounded up to a power of two). Call before
+    // any thread records.
+    void Enable(size_t events_per_thread) {
+        size_t capacity = 1;
+        while (capacity < events_per_thread) capacity <<= 1;
+        capacity_.store(events_per_thread ? capacity : 0, std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] bool enabled() const { return capacity_.load(std::memory_order_relaxed) != 0; }
+
+    // Track name for the calling thread in the dump ("Worker 2").
+    void SetThreadName(std::string name) {
+        if (!enabled()) return;
+        Ring& ring = local_ring();
+        std::lock_guard<std::mutex> lock(rings_mtx_);
+        ring.name = std::move(name);
+    }
+
+    void record(uint32_t scope, std::chrono::steady_clock::time_point start,
+                std::chrono::steady_clock::time_point end) {
+        Ring& ring = local_ring();
+        uint64_t head = ring.head.load(std::memory_order_relaxed);
+        Event& event = ring.events[head & ring.mask];
+        event.start_ns.store(start.time_since_epoch().count(), std::memory_order_relaxed);
+        event.duration_ns.store((end - start).count(), std::memory_order_relaxed);
+        event.scope.store(scope, std::memory_order_relaxed);
+        ring.head.store(head + 1, std::memory_order_release);
+    }
+
+    // SIGUSR2 asks for a dump of the window before the signal; the report
+    // loop writes it with DumpIfRequested().
+    void InstallDumpSignal();
+    // Writes trace-<unix time>.json if a dump was requested. Returns its path,
+    // or an empty string.
+    std::string DumpIfRequested(long long window_ms);
+    // Events that finished in [end_ns - window_ns, end_ns] (steady clock).
+    bool WriteChromeTrace(const std::string& path, long long end_ns, long long window_ns);
+
+private:
+    struct Event {
+        std::atomic<long long> start_ns{0};
+        std::atomic<long long> duration_ns{0};
+        std::atomic<uint32_t> scope{0};
+    };
+    struct Ring {
+        explicit Ring(size_t capacity) : events(capacity), mask(capacity - 1) {}
+        std::vector<Event> events;
+        uint64_t mask;
+        alignas(64) std::atomic<uint64_t> head{0};  // Events ever written
+        std::string name;                           // Under rings_mtx_
+    };
+
+    Ring& local_ring() {
+        thread_local Ring *ring = nullptr;
+        if (!ring) {
+            auto owned = std::make_unique<Ring>(capacity_.load(std::memory_order_relaxed));
+            ring = owned.get();
+            std::lock_guard<std::mutex> lock(rings_mtx_);
+            rings_.push_back(std::move(owned));
+        }
+        return *ring;
+    }
+
+    std::atomic<size_t> capacity_{0};
+    std::mutex rings_mtx_;
+    std::vector<std::unique_ptr<Ring>> rings_;
+};
+
+#endif
@@ -0,0 +1,50 @@
+#ifndef WORKER_MAILBOX_H
+#define WORKER_MAILBOX_H
+
+#include <memory>
+
+#include "game_object.h"
+#include "mpsc_queue.h"
+
+// Something one worker did to an object another worker owns.
+struct WorkerEvent {
+    enum class Kind { kKill };
+
+    Kind kind = Kind::kKill;
+    std::shared_ptr<GameObject> object;
+    long long time = 0;  // Game time it happened
+};
+
+// One lock-free inbox per worker for cross-worker effects. A worker that
+// needs to change an object it does not own posts the change to the owner's
+// mailbox; the owner applies it on its own thread at the start of its next
+// tick, so every write to an object comes from one thread.
+class WorkerMailboxes {
+public:
+    explicit WorkerMailboxes(int workers) : boxes_(std::make_unique<MpscQueue<WorkerEvent>[]>(workers)) {}
+
+    // Any thread.
+    void Post(int worker, WorkerEvent event) { boxes_[worker].Push(std::move(event)); }
+
+    // Worker `worker`'s thread only. Calls apply(event) for each waiting event
+    // and returns how many there were.
+    template <typename Apply>
+    size_t Drain(int worker, Apply&& apply) {
+        size_t count = 0;
+        WorkerEvent event;
+        while (boxes_[worker].TryPop(event)) {
+            apply(event);
+            event.object.reset();
+            count++;
+        }
+        return count;
+    }
+
+private:
+    std::unique_ptr<MpscQueue<WorkerEvent>[]> boxes_;
+};
+
+// Null with a single game thread (one worker, or simulation mode).
+extern std::shared_ptr<WorkerMailboxes> mailboxes;
+
+#endif